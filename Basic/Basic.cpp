@@ -4,36 +4,148 @@
  * This file is the starter project for the BASIC interpreter.
  */
 
+#include <cstddef>
+#include <cstring>
+#include <fstream>
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <unistd.h>
 
+#include "cfg.h"
 #include "exp.h"
+#include "input.h"
+#include "keyword.h"
+#include "lexer.h"
+#include "output.h"
 #include "parser.h"
 #include "program.h"
+#include "stats.h"
 
 #include "../StanfordCPPLib/error.h"
-#include "../StanfordCPPLib/tokenscanner.h"
-#include "../StanfordCPPLib/simpio.h"
 #include "../StanfordCPPLib/strlib.h"
 
 /* Function prototypes */
+int runFile(int argc, char *argv[], Program &program, EvalState &state);
 void processLine(std::string &line, Program &program, EvalState &state);
+void addProgramLine(std::string &line, Program &program);
 void scan(std::string &line, Program &program, EvalState &state);
 Statement *newStatement(const std::string &line);
 
 /* Main program */
-int main() {
+int main(int argc, char *argv[]) {
     EvalState state;
     Program program;
-    while (true) {
+    if (argc > 1) return runFile(argc, argv, program, state);
+    output().setLineBuffered(isatty(STDOUT_FILENO));
+    std::string input;
+    while (inputReader().readLine(input)) {
         try {
-            string input = getLine();
             if (input.empty()) continue;
             processLine(input, program, state);
         } catch (ErrorException &ex) {
-            std::cout << ex.getMessage() << std::endl;
+            output().write(ex.getMessage());
+            output().endLine();
         }
     }
+    output().flush();
+    return 0;
+}
+
+/**
+ * Batch Mode
+ * @param argc
+ * @param argv the Command Line: a program file, optionally followed by
+ * "--input" and a data file, "--vm" to run on the bytecode VM, "--reg" to
+ * run on the register machine, "--jit" to run as native code, and
+ * "--line-buffered" to flush the output at the end of every line
+ * @param program The place where program is stored
+ * @param state Evaluation State to Store the Value of Identifiers
+ * @return the Exit Status: 0 on success, 1 if the program has an error,
+ * and 2 if the command line or a file is unusable
+ *
+ * Reads the whole program file at once, loads every line of it, and runs
+ * it without any REPL.  Every line of the file must begin with a line
+ * number; a line that does not load stops the interpreter before the
+ * program runs.  INPUT reads from the data file if one is given, or from
+ * the standard input otherwise.
+ */
+int runFile(int argc, char *argv[], Program &program, EvalState &state) {
+    const char *programPath = nullptr;
+    const char *inputPath = nullptr;
+    bool useVM = false;
+    bool useRegisters = false;
+    bool useNative = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            inputPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--vm") == 0) {
+            useVM = true;
+        } else if (std::strcmp(argv[i], "--reg") == 0) {
+            useRegisters = true;
+        } else if (std::strcmp(argv[i], "--jit") == 0) {
+            useNative = true;
+        } else if (std::strcmp(argv[i], "--line-buffered") == 0) {
+            output().setLineBuffered(true);
+        } else if (argv[i][0] != '-' && programPath == nullptr) {
+            programPath = argv[i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " program.bas [--input data.txt] [--vm | --reg | --jit] [--line-buffered]" << std::endl;
+            return 2;
+        }
+    }
+    if (programPath == nullptr) {
+        std::cerr << "Usage: " << argv[0] << " program.bas [--input data.txt] [--vm | --reg | --jit] [--line-buffered]" << std::endl;
+        return 2;
+    }
+
+    std::ifstream file(programPath, std::ios::binary);
+    if (!file) {
+        std::cerr << argv[0] << ": cannot open " << programPath << std::endl;
+        return 2;
+    }
+    // read in chunks rather than by the size of the file, which a pipe
+    // such as /dev/stdin does not have
+    std::string source;
+    char chunk[65536];
+    while (file.read(chunk, sizeof(chunk)) || file.gcount() > 0) {
+        source.append(chunk, std::size_t(file.gcount()));
+    }
+    if (file.bad()) {
+        std::cerr << argv[0] << ": cannot read " << programPath << std::endl;
+        return 2;
+    }
+
+    if (inputPath != nullptr && !inputReader().open(inputPath)) {
+        std::cerr << argv[0] << ": cannot open " << inputPath << std::endl;
+        return 2;
+    }
+
+    try {
+        std::size_t begin = 0;
+        while (begin < source.size()) {
+            std::size_t end = source.find('\n', begin);
+            if (end == std::string::npos) end = source.size();
+            std::size_t length = end - begin;
+            if (length > 0 && source[end - 1] == '\r') --length;
+            std::string line = source.substr(begin, length);
+            begin = end + 1;
+            if (line.empty()) continue;
+            if (line[0] < 48 || line[0] > 57) error("SYNTAX ERROR");
+            addProgramLine(line, program);
+        }
+        if (useVM) program.runBytecode(state);
+        else if (useRegisters) program.runRegisters(state);
+        else if (useNative) program.runNative(state);
+        else program.run(state);
+    } catch (ErrorException &ex) {
+        output().write(ex.getMessage());
+        output().endLine();
+        output().flush();
+        return 1;
+    }
+    output().flush();
+    return 0;
 }
 
 /**
@@ -49,28 +161,9 @@ int main() {
  * or one of the BASIC commands, such as LIST or RUN.
  */
 void processLine(std::string &line, Program &program, EvalState &state) {
-    TokenScanner scanner;
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    scanner.setInput(line);
-
     // For the case of BASIC program
     if (line[0] > 47 && line[0] < 58) {
-        int i = 1;
-        int number = line[0] - 48;
-        for (; i < line.length(); ++i) {
-            if (line[i] == ' ') break;
-            if (line[i] < 48 || line[i] > 57) error("SYNTAX ERROR");
-            number = number * 10 + line[i] - 48;
-        }
-        if (i == line.length()) {
-            program.removeSourceLine(number);
-        } else {
-            ++i;
-            line = line.substr(i);
-            Statement *stmt = newStatement(line);
-            program.addSourceLine(number, stmt);
-        }
+        addProgramLine(line, program);
         return;
     }
 
@@ -78,6 +171,31 @@ void processLine(std::string &line, Program &program, EvalState &state) {
     scan(line, program, state);
 }
 
+/**
+ * @param line A Line Beginning with a Line Number
+ * @param program The place where program is stored
+ *
+ * Stores the statement of the line in the program, or removes the line
+ * from the program if nothing follows the line number.
+ */
+void addProgramLine(std::string &line, Program &program) {
+    std::size_t i = 1;
+    int number = line[0] - 48;
+    for (; i < line.length(); ++i) {
+        if (line[i] == ' ') break;
+        if (line[i] < 48 || line[i] > 57) error("SYNTAX ERROR");
+        number = number * 10 + line[i] - 48;
+    }
+    if (i == line.length()) {
+        program.removeSourceLine(number);
+    } else {
+        ++i;
+        line = line.substr(i);
+        Statement *stmt = newStatement(line);
+        program.addSourceLine(number, stmt);
+    }
+}
+
 /**
  * Scan the New Line
  * @param line the Entered Line
@@ -89,36 +207,60 @@ void processLine(std::string &line, Program &program, EvalState &state) {
  */
 void scan(std::string &line, Program &program, EvalState &state) {
     Statement *newStmt = nullptr;
-    TokenScanner scanner;
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    scanner.setInput(line);
-    std::string stmt = scanner.nextToken();
-    if (stmt == "LET") {
-        newStmt = new LET(line);
-    } else if (stmt == "PRINT") {
-        newStmt = new PRINT(line);
-    } else if (stmt == "INPUT") {
-        newStmt = new INPUT(line);
-    } else if (stmt == "RUN") {
-        program.run(state);
-        return;
-    } else if (stmt == "LIST") {
-        program.list();
-        return;
-    } else if (stmt == "CLEAR") {
-        program.clear();
-        state.clear();
-        return;
-    } else if (stmt == "QUIT") {
-        exit(0);
-    } else if (stmt == "HELP") {
-        std::cout << "Yet another basic interpreter" << std::endl;
-        return;
-    } else {
-        error("SYNTAX ERROR");
+    Lexer lexer(line);
+    std::string_view command = lexer.nextToken().text;
+    switch (toKeyword(command)) {
+        case KEYWORD_LET:
+            newStmt = new LET(line, lexer);
+            break;
+        case KEYWORD_PRINT:
+            newStmt = new PRINT(line, lexer);
+            break;
+        case KEYWORD_INPUT:
+            newStmt = new INPUT(line, lexer);
+            break;
+        case KEYWORD_RUN: {
+            std::string_view mode = lexer.nextToken().text;
+            if (mode.empty()) program.run(state);
+            else if (mode == "VM" && !lexer.hasMoreTokens()) program.runBytecode(state);
+            else if (mode == "REG" && !lexer.hasMoreTokens()) program.runRegisters(state);
+            else if (mode == "JIT" && !lexer.hasMoreTokens()) program.runNative(state);
+            else error("SYNTAX ERROR");
+            return;
+        }
+        case KEYWORD_LIST:
+            program.list();
+            return;
+        case KEYWORD_CLEAR:
+            program.clear();
+            state.clear();
+            return;
+        case KEYWORD_QUIT:
+            output().flush();
+            exit(0);
+        case KEYWORD_HELP:
+            output().write("Yet another basic interpreter");
+            output().endLine();
+            return;
+        default:
+            // STATS and CFG are not reserved, so they are matched literally,
+            // like the modes of RUN, and stay usable as variables
+            if (command == "STATS" && !lexer.hasMoreTokens()) {
+                statistics().print(output());
+                return;
+            }
+            if (command == "CFG" && !lexer.hasMoreTokens()) {
+                ControlFlowGraph(program).print(output());
+                return;
+            }
+            error("SYNTAX ERROR");
+    }
+    try {
+        newStmt->execute(program, state);
+    } catch (...) {
+        delete newStmt;
+        throw;
     }
-    newStmt->execute(program, state);
     delete newStmt;
 }
 
@@ -128,87 +270,23 @@ void scan(std::string &line, Program &program, EvalState &state) {
  * @return Statement Pointer of its Derived Class
  *
  * This function serves for the full program.  It process a line (without the
- * number head) and check the syntax of a line.  To avoid extra problems like
- * memory leak, syntax error MUST be checked before construct a statement
- * class.
+ * number head) and check the syntax of a line.  The line is scanned only
+ * once: the keyword is read here, and the constructor checks the rest of
+ * the line while it builds the statement, with the stricter rules of
+ * program lines.  A constructor that throws leaves nothing behind, since
+ * the nodes it has parsed belong to the arena of the statement.
  */
 Statement *newStatement(const std::string &line) {
-    TokenScanner scanner;
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    scanner.setInput(line);
-    std::string stmt = scanner.nextToken();
-
-    if (stmt == "LET") {
-        std::string identifier = scanner.nextToken();
-        if (!identifierCheck(identifier)) error("SYNTAX ERROR");
-        if (scanner.nextToken() != "=") error("SYNTAX ERROR");
-        std::string token = scanner.nextToken();
-        while (!token.empty()) {
-            if (token == "=") error("SYNTAX ERROR");
-            token = scanner.nextToken();
-        }
-        return new LET(line);
-    }
-
-    if (stmt == "PRINT") {
-        for (int i = 6; i < line.length(); ++i) {
-            if (!isValidChar(line[i])) error("SYNTAX ERROR");
-        }
-        return new PRINT(line);
-    }
-
-    if (stmt == "REM") return new REM(line);
-
-    if (stmt == "INPUT") {
-        std::string identifier = scanner.nextToken();
-        if (!identifierCheck(identifier)) error("SYNTAX ERROR");
-        if (scanner.hasMoreTokens()) error("SYNTAX ERROR");
-        return new INPUT(line);
-    }
-
-    if (stmt == "END") {
-        if (scanner.hasMoreTokens()) error("SYNTAX ERROR");
-        return new END(line);
-    }
-
-    if (stmt == "GOTO") {
-        std::string lineNumber = scanner.nextToken();
-        if (!numberCheck(lineNumber)) error("SYNTAX ERROR");
-        if (scanner.hasMoreTokens()) error("SYNTAX ERROR");
-        return new GOTO(line);
-    }
-
-    if (stmt == "IF") {
-        std::string token = scanner.nextToken();
-
-        // Check first value
-        while (!token.empty() && token != "<" && token != ">" && token != "=") {
-            for (char i : token) {
-                if (!isValidChar(i)) error("SYNTAX ERROR");
-            }
-            token = scanner.nextToken();
-        }
-
-        // Check second value
-        if (token.empty()) error("SYNTAX ERROR");
-        token = scanner.nextToken();
-        while (!token.empty() && token != "THEN") {
-            if (token == "<" || token == ">" || token == "=") error("SYNTAX ERROR");
-            for (char i : token) {
-                if (!isValidChar(i)) error("SYNTAX ERROR");
-            }
-            token = scanner.nextToken();
-        }
-
-        // Check THEN
-        if (token.empty()) error("SYNTAX ERROR");
-
-        // Check number
-        std::string lineNumber = scanner.nextToken();
-        if (!numberCheck(lineNumber)) error("SYNTAX ERROR");
-        if (scanner.hasMoreTokens()) error("SYNTAX ERROR");
-        return new IF(line);
+    Lexer lexer(line);
+    switch (toKeyword(lexer.nextToken().text)) {
+        case KEYWORD_LET: return new LET(line, lexer, true);
+        case KEYWORD_PRINT: return new PRINT(line, lexer, true);
+        case KEYWORD_REM: return new REM(line);
+        case KEYWORD_INPUT: return new INPUT(line, lexer);
+        case KEYWORD_END: return new END(line, lexer);
+        case KEYWORD_GOTO: return new GOTO(line, lexer);
+        case KEYWORD_IF: return new IF(line, lexer);
+        default: break;
     }
 
     error("SYNTAX ERROR");
@@ -0,0 +1,54 @@
+/**
+ * @file arena.cpp
+ *
+ * This file implements the ExpArena class.
+ */
+
+#include <cstdint>
+#include <cstdlib>
+#include "arena.h"
+#include "exp.h"
+
+/**
+ * The first chunk is small, because most statements hold only a handful of
+ * nodes; every further chunk doubles the size of the previous one.
+ */
+static const std::size_t FIRST_CHUNK_SIZE = 256;
+
+ExpArena::ExpArena() = default;
+
+ExpArena::~ExpArena() {
+    destroyNodes();
+    while (_chunks != nullptr) {
+        Chunk *next = _chunks->next;
+        std::free(_chunks);
+        _chunks = next;
+    }
+}
+
+void *ExpArena::allocate(std::size_t size, std::size_t align) {
+    auto top = (std::uintptr_t) _top;
+    top = (top + align - 1) & ~(std::uintptr_t) (align - 1);
+    if (_top == nullptr || top + size > (std::uintptr_t) _limit) {
+        std::size_t chunkSize = _chunks == nullptr ? FIRST_CHUNK_SIZE : _chunks->size * 2;
+        while (chunkSize < size + align) chunkSize *= 2;
+        auto *chunk = (Chunk *) std::malloc(sizeof(Chunk) + chunkSize);
+        if (chunk == nullptr) throw std::bad_alloc();
+        chunk->next = _chunks;
+        chunk->size = chunkSize;
+        _chunks = chunk;
+        _top = (char *) (chunk + 1);
+        _limit = _top + chunkSize;
+        top = (std::uintptr_t) _top;
+        top = (top + align - 1) & ~(std::uintptr_t) (align - 1);
+    }
+    _top = (char *) (top + size);
+    return (void *) top;
+}
+
+void ExpArena::destroyNodes() {
+    for (Expression *node : _nodes) {
+        node->~Expression();
+    }
+    _nodes.clear();
+}
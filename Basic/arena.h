@@ -0,0 +1,67 @@
+/**
+ * @file arena.h
+ *
+ * This interface exports the ExpArena class, a bump allocator that owns
+ * the nodes of expression trees.
+ */
+
+#ifndef _arena_h
+#define _arena_h
+
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+class Expression;
+
+/**
+ * @class ExpArena
+ *
+ * Nodes are carved out of large chunks by bumping a pointer, and every
+ * node of the arena is destroyed at once with the arena.  A statement
+ * parses its trees into an arena that lives as long as its constructor,
+ * so expression nodes never need to be deleted one by one and a parse
+ * error halfway through a line cannot leak the nodes built so far.
+ */
+class ExpArena {
+public:
+    ExpArena();
+
+    ~ExpArena();
+
+    ExpArena(const ExpArena &) = delete;
+
+    ExpArena &operator=(const ExpArena &) = delete;
+
+    /**
+     * Make a Node
+     * @tparam T a Subclass of Expression
+     * @param args Arguments of the Constructor of T
+     * @return a Node Owned by the Arena
+     */
+    template <typename T, typename... Args>
+    T *make(Args &&... args) {
+        void *memory = allocate(sizeof(T), alignof(T));
+        T *node = new (memory) T(std::forward<Args>(args)...);
+        _nodes.push_back(node);
+        return node;
+    }
+
+private:
+    struct Chunk {
+        Chunk *next;
+        std::size_t size;
+    };
+
+    void *allocate(std::size_t size, std::size_t align);
+
+    void destroyNodes();
+
+    Chunk *_chunks = nullptr;
+    char *_top = nullptr;
+    char *_limit = nullptr;
+    std::vector<Expression *> _nodes;
+};
+
+#endif
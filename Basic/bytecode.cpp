@@ -0,0 +1,258 @@
+/**
+ * @file bytecode.cpp
+ *
+ * This file implements the BytecodeCompiler class.
+ */
+
+#include <climits>
+#include <cstddef>
+#include <string>
+#include <utility>
+#include "bytecode.h"
+#include "stats.h"
+
+#include "../StanfordCPPLib/error.h"
+
+Bytecode BytecodeCompiler::compile(Program &program) {
+    _bytecode = Bytecode();
+    _lineAddress.clear();
+    _jumps.clear();
+    _depth = 0;
+
+    for (auto &line : program.getLines()) {
+        _lineAddress[line.first] = int(_bytecode.code.size());
+        compileStatement(line.second);
+    }
+    emit(OP_HALT);
+
+    // Patch jumps.  A missing line is reported before anything runs, just
+    // like Program::run does.
+    for (auto &jump : _jumps) {
+        auto target = _lineAddress.find(jump.second);
+        if (target == _lineAddress.end()) error("LINE NUMBER ERROR");
+        _bytecode.code[jump.first].operand = target->second;
+    }
+    threadJumps();
+    return std::move(_bytecode);
+}
+
+void BytecodeCompiler::compileStatement(Statement *stmt) {
+    switch (stmt->getType()) {
+        case REM_STMT:
+            break;
+        case LET_STMT: {
+            auto *let = (LET *) stmt;
+            if (compileFusedLet(let)) break;
+            compileExp(let->getExp());
+            emit(OP_STORE, let->getSlot());
+            break;
+        }
+        case PRINT_STMT:
+            compileExp(((PRINT *) stmt)->getExp());
+            emit(OP_PRINT);
+            break;
+        case INPUT_STMT:
+            emit(OP_INPUT, ((INPUT *) stmt)->getSlot());
+            break;
+        case END_STMT:
+            emit(OP_HALT);
+            break;
+        case GOTO_STMT:
+            emitJump(OP_JUMP, ((GOTO *) stmt)->getLineNumber());
+            break;
+        case IF_STMT: {
+            auto *ifStmt = (IF *) stmt;
+            if (compileFusedIf(ifStmt)) break;
+            compileExp(ifStmt->getLHS());
+            compileExp(ifStmt->getRHS());
+            switch (ifStmt->getComparison()) {
+                case LESS_THAN: emitJump(OP_JUMP_LESS, ifStmt->getLineNumber()); break;
+                case GREATER_THAN: emitJump(OP_JUMP_GREATER, ifStmt->getLineNumber()); break;
+                case EQUAL_TO: emitJump(OP_JUMP_EQUAL, ifStmt->getLineNumber()); break;
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * Every operation of a postfix expression has an instruction of its own.
+ * An assignment whose left operand is not an identifier reports the same
+ * error the tree-walking evaluator does, at the same point.
+ */
+void BytecodeCompiler::compileExp(const PostfixExp &exp) {
+    for (const PostfixOp &op : exp.getOps()) {
+        switch (op.code) {
+            case PF_CONST: emit(OP_PUSH_CONST, op.operand); break;
+            case PF_LOAD: emit(OP_LOAD, op.operand); break;
+            case PF_ADD: emit(OP_ADD); break;
+            case PF_SUB: emit(OP_SUB); break;
+            case PF_MUL: emit(OP_MUL); break;
+            case PF_DIV: emit(OP_DIV); break;
+            case PF_ADD_CONST: emit(OP_ADD_CONST, op.operand); break;
+            case PF_SUB_CONST: emit(OP_SUB_CONST, op.operand); break;
+            case PF_MUL_CONST: emit(OP_MUL_CONST, op.operand); break;
+            case PF_DIV_CONST: emit(OP_DIV_CONST, op.operand); break;
+            case PF_ADD_VAR: emit(OP_ADD_LOAD, op.operand); break;
+            case PF_SUB_VAR: emit(OP_SUB_LOAD, op.operand); break;
+            case PF_MUL_VAR: emit(OP_MUL_LOAD, op.operand); break;
+            case PF_DIV_VAR: emit(OP_DIV_LOAD, op.operand); break;
+            case PF_ASSIGN: emit(OP_ASSIGN, op.operand); break;
+            case PF_ILLEGAL_ASSIGN: emit(OP_FAIL, messageOf("Illegal variable in assignment")); break;
+        }
+        if (op.code >= PF_ADD_CONST && op.code <= PF_DIV_VAR) ++statistics().fusedOperands;
+    }
+}
+
+/**
+ * Implementation notes: compileFusedLet
+ * <br>
+ * Matches LET V = V + C, V = C + V and V = V - C, which add a constant to
+ * V, and LET V = V + W and V = W + V, which add W to V.  Both operands are
+ * checked for being defined when the instruction runs, so an undefined
+ * variable is reported just as before.  V - C is left alone when -C does
+ * not fit in an int.
+ */
+bool BytecodeCompiler::compileFusedLet(LET *let) {
+    const std::vector<PostfixOp> &ops = let->getExp().getOps();
+    int slot = let->getSlot();
+    if (ops.size() != 2) return false;
+    const PostfixOp &first = ops[0], &second = ops[1];
+
+    if (first.code == PF_LOAD && first.operand == slot) {
+        if (second.code == PF_ADD_CONST) {
+            emit(OP_INC_CONST, slot, second.operand);
+        } else if (second.code == PF_SUB_CONST && second.operand != INT_MIN) {
+            emit(OP_INC_CONST, slot, -second.operand);
+        } else if (second.code == PF_ADD_VAR) {
+            emit(OP_INC_VAR, slot, second.operand);
+        } else {
+            return false;
+        }
+    } else if (second.code == PF_ADD_VAR && second.operand == slot) {
+        if (first.code == PF_CONST) {
+            emit(OP_INC_CONST, slot, first.operand);
+        } else if (first.code == PF_LOAD) {
+            emit(OP_INC_VAR, slot, first.operand);
+        } else {
+            return false;
+        }
+    } else {
+        return false;
+    }
+
+    if (_bytecode.code.back().op == OP_INC_CONST) ++statistics().fusedIncrements;
+    else ++statistics().fusedVariableAdds;
+    return true;
+}
+
+/**
+ * Implementation notes: compileFusedIf
+ * <br>
+ * Matches a comparison of a variable with a variable or a constant.  A
+ * constant on the left is moved to the right by mirroring the comparison,
+ * which is safe since evaluating a constant cannot fail.
+ */
+bool BytecodeCompiler::compileFusedIf(IF *ifStmt) {
+    const std::vector<PostfixOp> &lhs = ifStmt->getLHS().getOps();
+    const std::vector<PostfixOp> &rhs = ifStmt->getRHS().getOps();
+    if (lhs.size() != 1 || rhs.size() != 1) return false;
+    PostfixOp left = lhs[0], right = rhs[0];
+    Comparison comparison = ifStmt->getComparison();
+
+    if (left.code == PF_CONST && right.code == PF_LOAD) {
+        std::swap(left, right);
+        if (comparison == LESS_THAN) comparison = GREATER_THAN;
+        else if (comparison == GREATER_THAN) comparison = LESS_THAN;
+    }
+    if (left.code != PF_LOAD) return false;
+
+    if (right.code != PF_LOAD && right.code != PF_CONST) return false;
+    bool variable = right.code == PF_LOAD;
+    OpCode op = variable ? OP_JUMP_VAR_LESS_VAR : OP_JUMP_VAR_LESS_CONST;
+    if (comparison == GREATER_THAN) op = variable ? OP_JUMP_VAR_GREATER_VAR : OP_JUMP_VAR_GREATER_CONST;
+    if (comparison == EQUAL_TO) op = variable ? OP_JUMP_VAR_EQUAL_VAR : OP_JUMP_VAR_EQUAL_CONST;
+    _jumps.emplace_back(int(_bytecode.code.size()), ifStmt->getLineNumber());
+    emit(op, -1, left.operand, right.operand);
+    ++statistics().fusedBranches;
+    return true;
+}
+
+static bool isJump(OpCode op) {
+    switch (op) {
+        case OP_JUMP:
+        case OP_JUMP_LESS:
+        case OP_JUMP_GREATER:
+        case OP_JUMP_EQUAL:
+        case OP_JUMP_VAR_LESS_VAR:
+        case OP_JUMP_VAR_GREATER_VAR:
+        case OP_JUMP_VAR_EQUAL_VAR:
+        case OP_JUMP_VAR_LESS_CONST:
+        case OP_JUMP_VAR_GREATER_CONST:
+        case OP_JUMP_VAR_EQUAL_CONST:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Implementation notes: threadJumps
+ * <br>
+ * A jump landing on an OP_JUMP, as a GOTO to a line holding another GOTO
+ * does, is redirected to where that one leads.  The chain is followed for
+ * at most as many steps as there are instructions, so that a loop made
+ * of GOTOs only is left as it is after that.
+ */
+void BytecodeCompiler::threadJumps() {
+    std::vector<Instruction> &code = _bytecode.code;
+    for (Instruction &ins : code) {
+        if (!isJump(ins.op)) continue;
+        int target = ins.operand;
+        for (std::size_t steps = 0; code[target].op == OP_JUMP && steps < code.size(); ++steps) {
+            target = code[target].operand;
+        }
+        if (target != ins.operand) {
+            ins.operand = target;
+            ++statistics().threadedJumps;
+        }
+    }
+}
+
+void BytecodeCompiler::emit(OpCode op, int operand, int a, int b) {
+    _bytecode.code.push_back({op, operand, a, b});
+    switch (op) {
+        case OP_PUSH_CONST:
+        case OP_LOAD:
+            if (++_depth > _bytecode.maxStackDepth) _bytecode.maxStackDepth = _depth;
+            break;
+        case OP_STORE:
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+        case OP_PRINT:
+            --_depth;
+            break;
+        case OP_JUMP_LESS:
+        case OP_JUMP_GREATER:
+        case OP_JUMP_EQUAL:
+            _depth -= 2;
+            break;
+        default:
+            break;
+    }
+}
+
+void BytecodeCompiler::emitJump(OpCode op, int lineNumber) {
+    _jumps.emplace_back(int(_bytecode.code.size()), lineNumber);
+    emit(op, -1);
+}
+
+int BytecodeCompiler::messageOf(const std::string &message) {
+    for (std::size_t i = 0; i < _bytecode.messages.size(); ++i) {
+        if (_bytecode.messages[i] == message) return int(i);
+    }
+    _bytecode.messages.push_back(message);
+    return int(_bytecode.messages.size()) - 1;
+}
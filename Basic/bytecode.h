@@ -0,0 +1,125 @@
+/**
+ * @file bytecode.h
+ *
+ * This interface defines the instruction set of the stack-based virtual
+ * machine and a compiler that lowers a whole Program into a flat array of
+ * instructions whose jump targets are already resolved.
+ */
+
+#ifndef _bytecode_h
+#define _bytecode_h
+
+#include <map>
+#include <string>
+#include <vector>
+#include "postfix.h"
+#include "program.h"
+#include "statement.h"
+
+/**
+ * @enum OpCode
+ *
+ * The operations of the virtual machine.  Every operation works on the
+ * value stack; the operand of an instruction is a constant, a variable
+ * slot, a jump target or a message index, depending on the operation.
+ *
+ * The operations from OP_ADD_CONST on are superinstructions, each doing
+ * the work of a common sequence of simpler ones.  Those which need more
+ * than one operand take the others from a and b.
+ */
+enum OpCode {
+    OP_PUSH_CONST,   // push operand
+    OP_LOAD,         // push the variable in slot operand
+    OP_STORE,        // pop into the variable in slot operand
+    OP_ASSIGN,       // store the top into slot operand, but keep it
+    OP_ADD, OP_SUB, OP_MUL, OP_DIV,
+    OP_JUMP,         // jump to instruction operand
+    OP_JUMP_LESS,    // pop rhs and lhs, and jump to operand if lhs < rhs
+    OP_JUMP_GREATER, // pop rhs and lhs, and jump to operand if lhs > rhs
+    OP_JUMP_EQUAL,   // pop rhs and lhs, and jump to operand if lhs == rhs
+    OP_PRINT,        // pop and print
+    OP_INPUT,        // read a value into slot operand
+    OP_FAIL,         // report messages[operand]
+    OP_HALT,
+    OP_ADD_CONST, OP_SUB_CONST, OP_MUL_CONST, OP_DIV_CONST, // top = top op operand
+    OP_ADD_LOAD, OP_SUB_LOAD, OP_MUL_LOAD, OP_DIV_LOAD,     // top = top op slot operand
+    OP_INC_CONST,    // add a to the variable in slot operand
+    OP_INC_VAR,      // add the variable in slot a to the variable in slot operand
+    OP_JUMP_VAR_LESS_VAR,      // jump to operand if slot a < slot b
+    OP_JUMP_VAR_GREATER_VAR,   // jump to operand if slot a > slot b
+    OP_JUMP_VAR_EQUAL_VAR,     // jump to operand if slot a == slot b
+    OP_JUMP_VAR_LESS_CONST,    // jump to operand if slot a < b
+    OP_JUMP_VAR_GREATER_CONST, // jump to operand if slot a > b
+    OP_JUMP_VAR_EQUAL_CONST    // jump to operand if slot a == b
+};
+
+struct Instruction {
+    OpCode op;
+    int operand;
+    int a = 0;
+    int b = 0;
+};
+
+/**
+ * @class Bytecode
+ *
+ * The compiled form of a whole program.  Variables are referred to by
+ * their EvalState slots.
+ */
+class Bytecode {
+public:
+    std::vector<Instruction> code;
+    std::vector<std::string> messages;
+    int maxStackDepth = 0;
+};
+
+/**
+ * @class BytecodeCompiler
+ *
+ * This class translates every statement of a Program in line order.
+ * Jumps are emitted with line numbers first and patched to instruction
+ * indices once the whole program has been laid out.  A jump to a line
+ * that does not exist is reported as LINE NUMBER ERROR during compilation,
+ * in the same way as Program::run does.
+ *
+ * Common statements are recognized and compiled into superinstructions:
+ * LET I = I + 1 becomes OP_INC_CONST, LET S = S + X becomes OP_INC_VAR,
+ * and an IF comparing a variable with a variable or a constant becomes a
+ * single compare-and-jump.  An operator whose right operand is a constant
+ * or a variable takes it directly, and a jump to an unconditional jump
+ * goes straight to the final target.  Every fusion is counted in
+ * statistics().
+ */
+class BytecodeCompiler {
+public:
+    /**
+     * Compile
+     * @param program The Program to Compile
+     * @return the Bytecode of the Whole Program
+     */
+    Bytecode compile(Program &program);
+
+private:
+    void compileStatement(Statement *stmt);
+
+    void compileExp(const PostfixExp &exp);
+
+    bool compileFusedLet(LET *let);
+
+    bool compileFusedIf(IF *ifStmt);
+
+    void threadJumps();
+
+    void emit(OpCode op, int operand = 0, int a = 0, int b = 0);
+
+    void emitJump(OpCode op, int lineNumber);
+
+    int messageOf(const std::string &message);
+
+    Bytecode _bytecode;
+    std::map<int, int> _lineAddress;
+    std::vector<std::pair<int, int>> _jumps;
+    int _depth = 0;
+};
+
+#endif
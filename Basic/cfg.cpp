@@ -0,0 +1,318 @@
+/**
+ * @file cfg.cpp
+ *
+ * This file implements the ControlFlowGraph class.
+ */
+
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <string>
+#include <string_view>
+#include <utility>
+#include "cfg.h"
+
+#include "../StanfordCPPLib/error.h"
+
+/**
+ * @return the Line Named by a GOTO or an IF, or -1 for Any Other Statement
+ */
+static int targetOf(Statement *stmt) {
+    switch (stmt->getType()) {
+        case GOTO_STMT: return ((GOTO *) stmt)->getLineNumber();
+        case IF_STMT: return ((IF *) stmt)->getLineNumber();
+        default: return -1;
+    }
+}
+
+ControlFlowGraph::ControlFlowGraph(const Program &program) : _lines(program.getLines()) {
+    findBlocks();
+    linkBlocks();
+    findDominators();
+    findLoops();
+}
+
+const std::vector<BasicBlock> &ControlFlowGraph::getBlocks() const {
+    return _blocks;
+}
+
+const std::vector<NaturalLoop> &ControlFlowGraph::getLoops() const {
+    return _loops;
+}
+
+int ControlFlowGraph::getBlockOf(int lineNumber) const {
+    return std::prev(_blockAt.upper_bound(lineNumber))->second;
+}
+
+bool ControlFlowGraph::dominates(int a, int b) const {
+    for (int block = b; block >= 0; block = _blocks[block].dominator) {
+        if (block == a) return true;
+    }
+    return false;
+}
+
+void ControlFlowGraph::findBlocks() {
+    std::set<int> leaders;
+    bool starts = true;
+    for (auto &line : _lines) {
+        if (starts) leaders.insert(line.first);
+        int target = targetOf(line.second);
+        if (target >= 0) {
+            if (_lines.count(target) == 0) error("LINE NUMBER ERROR");
+            leaders.insert(target);
+        }
+        StatementType type = line.second->getType();
+        starts = type == GOTO_STMT || type == IF_STMT || type == END_STMT;
+    }
+
+    for (auto &line : _lines) {
+        if (leaders.count(line.first)) {
+            _blockAt.emplace(line.first, int(_blocks.size()));
+            _blocks.emplace_back();
+            _blocks.back().first = line.first;
+        }
+        _blocks.back().last = line.first;
+    }
+}
+
+void ControlFlowGraph::linkBlocks() {
+    int count = int(_blocks.size());
+    for (int block = 0; block < count; ++block) {
+        Statement *stmt = _lines.at(_blocks[block].last);
+        StatementType type = stmt->getType();
+        std::vector<int> &successors = _blocks[block].successors;
+        if (type == GOTO_STMT || type == IF_STMT) successors.push_back(getBlockOf(targetOf(stmt)));
+        bool fallsThrough = type != GOTO_STMT && type != END_STMT && block + 1 < count;
+        if (fallsThrough && (successors.empty() || successors[0] != block + 1)) {
+            successors.push_back(block + 1);
+        }
+        for (int successor : successors) _blocks[successor].predecessors.push_back(block);
+    }
+}
+
+/**
+ * Implementation notes: findDominators
+ * <br>
+ * The iterative algorithm of Cooper, Harvey and Kennedy: the blocks are
+ * visited in reverse postorder, and the dominator of each one is where the
+ * dominator chains of its predecessors meet, until nothing changes.  The
+ * order is found by a depth-first search with an explicit stack, so a long
+ * program cannot overflow the native one.
+ */
+void ControlFlowGraph::findDominators() {
+    if (_blocks.empty()) return;
+    std::vector<int> order;
+    std::vector<std::pair<int, std::size_t>> stack{{0, 0}};
+    _blocks[0].reachable = true;
+    while (!stack.empty()) {
+        int block = stack.back().first;
+        std::size_t edge = stack.back().second++;
+        if (edge < _blocks[block].successors.size()) {
+            int successor = _blocks[block].successors[edge];
+            if (_blocks[successor].reachable) continue;
+            _blocks[successor].reachable = true;
+            stack.emplace_back(successor, 0);
+        } else {
+            order.push_back(block);
+            stack.pop_back();
+        }
+    }
+    std::reverse(order.begin(), order.end());
+
+    std::vector<int> rank(_blocks.size(), -1);
+    for (std::size_t i = 0; i < order.size(); ++i) rank[order[i]] = int(i);
+    std::vector<int> dominator(_blocks.size(), -1);
+    dominator[0] = 0;
+    auto meet = [&](int a, int b) {
+        while (a != b) {
+            while (rank[a] > rank[b]) a = dominator[a];
+            while (rank[b] > rank[a]) b = dominator[b];
+        }
+        return a;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (std::size_t i = 1; i < order.size(); ++i) {
+            int block = order[i];
+            int found = -1;
+            for (int predecessor : _blocks[block].predecessors) {
+                if (dominator[predecessor] < 0) continue;
+                found = found < 0 ? predecessor : meet(predecessor, found);
+            }
+            if (dominator[block] != found) {
+                dominator[block] = found;
+                changed = true;
+            }
+        }
+    }
+    for (std::size_t block = 1; block < _blocks.size(); ++block) {
+        _blocks[block].dominator = dominator[block];
+    }
+}
+
+/**
+ * Implementation notes: findLoops
+ * <br>
+ * An edge is a back edge when its target dominates its source.  The body
+ * of the loop is the header and every block reaching the source without
+ * going through the header, found by walking predecessors backwards.
+ * <br>
+ * A loop nested in another one has fewer blocks, so once the loops are
+ * taken from the largest down, each one is inside the loop its header was
+ * last given, and is the innermost loop of its blocks so far.
+ */
+void ControlFlowGraph::findLoops() {
+    std::map<int, std::vector<int>> latches;   // header, the blocks jumping back to it
+    for (int block = 0; block < int(_blocks.size()); ++block) {
+        if (!_blocks[block].reachable) continue;
+        for (int header : _blocks[block].successors) {
+            if (dominates(header, block)) latches[header].push_back(block);
+        }
+    }
+
+    std::vector<int> mark(_blocks.size(), -1);  // the header of the loop last taking the block
+    std::vector<int> work;
+    for (auto &latch : latches) {
+        int header = latch.first;
+        _loops.emplace_back();
+        NaturalLoop &loop = _loops.back();
+        loop.header = header;
+        loop.blocks.push_back(header);
+        mark[header] = header;
+        work = latch.second;
+        while (!work.empty()) {
+            int member = work.back();
+            work.pop_back();
+            if (mark[member] == header) continue;
+            mark[member] = header;
+            loop.blocks.push_back(member);
+            for (int predecessor : _blocks[member].predecessors) {
+                if (mark[predecessor] != header && _blocks[predecessor].reachable) work.push_back(predecessor);
+            }
+        }
+        std::sort(loop.blocks.begin(), loop.blocks.end());
+    }
+
+    std::vector<int> bySize(_loops.size());
+    for (std::size_t loop = 0; loop < _loops.size(); ++loop) bySize[loop] = int(loop);
+    std::stable_sort(bySize.begin(), bySize.end(), [&](int a, int b) {
+        return _loops[a].blocks.size() > _loops[b].blocks.size();
+    });
+    for (int loop : bySize) {
+        _loops[loop].parent = _blocks[_loops[loop].header].loop;
+        for (int block : _loops[loop].blocks) _blocks[block].loop = loop;
+    }
+}
+
+static void indent(OutputBuffer &out, int depth) {
+    for (int i = 0; i < depth; ++i) out.write("    ");
+}
+
+/**
+ * Writes the text inside a quoted dot string, ending it with a left
+ * justified line break.
+ */
+static void writeLabelLine(OutputBuffer &out, std::string_view text) {
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '"' && text[i] != '\\') continue;
+        out.write(text.substr(start, i - start));
+        out.write("\\");
+        start = i;
+    }
+    out.write(text.substr(start));
+    out.write("\\l");
+}
+
+void ControlFlowGraph::print(OutputBuffer &out) const {
+    out.write("digraph cfg {");
+    out.endLine();
+    indent(out, 1);
+    out.write("node [shape=box, fontname=\"monospace\"];");
+    out.endLine();
+    for (int loop = 0; loop < int(_loops.size()); ++loop) {
+        if (_loops[loop].parent < 0) printLoop(out, loop, 1);
+    }
+    for (int block = 0; block < int(_blocks.size()); ++block) {
+        if (_blocks[block].loop < 0) printBlock(out, block, 1);
+    }
+
+    for (int block = 0; block < int(_blocks.size()); ++block) {
+        const std::vector<int> &successors = _blocks[block].successors;
+        bool branches = _lines.at(_blocks[block].last)->getType() == IF_STMT;
+        for (std::size_t i = 0; i < successors.size(); ++i) {
+            std::string attributes;
+            if (branches && i == 0) attributes = "label=\"then\"";
+            if (_blocks[block].reachable && dominates(successors[i], block)) {
+                attributes += attributes.empty() ? "style=bold" : ", style=bold";
+            }
+            indent(out, 1);
+            out.write("b");
+            out.writeNumber(block);
+            out.write(" -> b");
+            out.writeNumber(successors[i]);
+            if (!attributes.empty()) {
+                out.write(" [");
+                out.write(attributes);
+                out.write("]");
+            }
+            out.write(";");
+            out.endLine();
+        }
+    }
+    out.write("}");
+    out.endLine();
+}
+
+void ControlFlowGraph::printLoop(OutputBuffer &out, int loop, int depth) const {
+    indent(out, depth);
+    out.write("subgraph cluster_");
+    out.writeNumber(loop);
+    out.write(" {");
+    out.endLine();
+    indent(out, depth + 1);
+    out.write("label=\"loop at ");
+    out.writeNumber(_blocks[_loops[loop].header].first);
+    out.write("\";");
+    out.endLine();
+    indent(out, depth + 1);
+    out.write("style=dashed;");
+    out.endLine();
+    for (int inner = 0; inner < int(_loops.size()); ++inner) {
+        if (_loops[inner].parent == loop) printLoop(out, inner, depth + 1);
+    }
+    for (int block : _loops[loop].blocks) {
+        if (_blocks[block].loop == loop) printBlock(out, block, depth + 1);
+    }
+    indent(out, depth);
+    out.write("}");
+    out.endLine();
+}
+
+void ControlFlowGraph::printBlock(OutputBuffer &out, int block, int depth) const {
+    const BasicBlock &basicBlock = _blocks[block];
+    indent(out, depth);
+    out.write("b");
+    out.writeNumber(block);
+    out.write(" [label=\"B");
+    out.writeNumber(block);
+    if (block == 0) {
+        out.write(", entry");
+    } else if (!basicBlock.reachable) {
+        out.write(", unreachable");
+    } else {
+        out.write(", idom B");
+        out.writeNumber(basicBlock.dominator);
+    }
+    out.write("\\l");
+    auto end = _lines.upper_bound(basicBlock.last);
+    for (auto line = _lines.find(basicBlock.first); line != end; ++line) {
+        out.writeNumber(line->first);
+        out.write(" ");
+        writeLabelLine(out, line->second->getSource());
+    }
+    out.write("\"];");
+    out.endLine();
+}
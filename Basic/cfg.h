@@ -0,0 +1,114 @@
+/**
+ * @file cfg.h
+ *
+ * This interface exports the ControlFlowGraph of a Program: its basic
+ * blocks, the edges between them, their dominators and natural loops.
+ */
+
+#ifndef _cfg_h
+#define _cfg_h
+
+#include <map>
+#include <vector>
+#include "output.h"
+#include "program.h"
+#include "statement.h"
+
+/**
+ * @struct BasicBlock
+ *
+ * A run of consecutive lines entered only at its first line and left only
+ * after its last one.  The successors of a block ending in an IF are its
+ * target first and then the block after it.
+ */
+struct BasicBlock {
+    int first = 0;                     // the first line number
+    int last = 0;                      // the last line number
+    std::vector<int> successors;
+    std::vector<int> predecessors;
+    int dominator = -1;                // the immediate one; -1 for the entry and unreachable blocks
+    bool reachable = false;
+    int loop = -1;                     // the innermost loop containing the block, if any
+};
+
+/**
+ * @struct NaturalLoop
+ *
+ * The blocks of a loop, from its header, which dominates them all, to the
+ * ones jumping back to the header.  Loops with the same header are merged
+ * into one, so two loops are either nested or disjoint.
+ */
+struct NaturalLoop {
+    int header = 0;
+    std::vector<int> blocks;           // in program order, the header among them
+    int parent = -1;                   // the innermost loop containing this one, if any
+};
+
+/**
+ * @class ControlFlowGraph
+ *
+ * A new block starts at the first line, at every line named by a jump and
+ * after every GOTO, IF and END.  A block falls through to the next one
+ * unless it ends in a GOTO or an END; one that falls off the end of the
+ * program, or ends in an END, has no successor.  Block 0 is the entry.
+ * <br>
+ * The graph is a snapshot: it refers to the lines of the program, which
+ * must not be edited while it is in use.
+ */
+class ControlFlowGraph {
+public:
+    /**
+     * @param program The Program to Analyse
+     *
+     * If a target line does not exist, LINE NUMBER ERROR is reported, as
+     * by every compiler of the program.
+     */
+    explicit ControlFlowGraph(const Program &program);
+
+    const std::vector<BasicBlock> &getBlocks() const;
+
+    const std::vector<NaturalLoop> &getLoops() const;
+
+    /**
+     * @param lineNumber A Line of the Program
+     * @return the Block Containing the Line
+     */
+    int getBlockOf(int lineNumber) const;
+
+    /**
+     * @return whether every path from the entry to block b goes through
+     *         block a; a block dominates itself
+     */
+    bool dominates(int a, int b) const;
+
+    /**
+     * Print
+     * @param out Where the Graph is Written
+     *
+     * Writes the graph in the dot language of Graphviz.  Every block is a
+     * box listing its lines and its immediate dominator, every loop a
+     * cluster around its blocks, and the edges back to a loop header are
+     * drawn bold.
+     */
+    void print(OutputBuffer &out) const;
+
+private:
+    void findBlocks();
+
+    void linkBlocks();
+
+    void findDominators();
+
+    void findLoops();
+
+    void printLoop(OutputBuffer &out, int loop, int depth) const;
+
+    void printBlock(OutputBuffer &out, int block, int depth) const;
+
+    const std::map<int, Statement *> &_lines;
+    std::vector<BasicBlock> _blocks;
+    std::vector<NaturalLoop> _loops;
+    std::map<int, int> _blockAt;       // first line number, block
+};
+
+#endif
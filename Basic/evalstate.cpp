@@ -13,23 +13,55 @@
 
 /** Implementation of the EvalState class */
 
+std::unordered_map<std::string, int> EvalState::_slots;
+
+std::vector<std::string> EvalState::_names;
+
 EvalState::EvalState() = default;
 
 EvalState::~EvalState() = default;
 
 void EvalState::setValue(const std::string& var, int value) {
-    _symbolTable[var] = value;
+    setValue(getSlot(var), value);
 }
 
 int EvalState::getValue(const std::string& var) {
-    return _symbolTable[var];
+    auto slot = _slots.find(var);
+    if (slot == _slots.end() || !isDefined(slot->second)) return 0;
+    return getValue(slot->second);
 }
 
 bool EvalState::isDefined(const std::string& var) {
-    return _symbolTable.count(var);
+    auto slot = _slots.find(var);
+    return slot != _slots.end() && isDefined(slot->second);
 }
 
 void EvalState::clear()
 {
-    _symbolTable.clear();
+    _values.clear();
+    _defined.clear();
+}
+
+int EvalState::getSlot(const std::string &var) {
+    auto slot = _slots.find(var);
+    if (slot != _slots.end()) return slot->second;
+    int newSlot = int(_names.size());
+    _names.push_back(var);
+    _slots.emplace(var, newSlot);
+    return newSlot;
+}
+
+const std::string &EvalState::getName(int slot) {
+    return _names[slot];
+}
+
+int EvalState::getSlotCount() {
+    return int(_names.size());
+}
+
+void EvalState::grow(int slot) {
+    int size = slot + 1;
+    if (size < getSlotCount()) size = getSlotCount();
+    _values.resize(size, 0);
+    _defined.resize(size, false);
 }
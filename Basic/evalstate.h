@@ -9,8 +9,10 @@
 #ifndef _evalstate_h
 #define _evalstate_h
 
+#include <cstddef>
 #include <string>
-#include <map>
+#include <unordered_map>
+#include <vector>
 #include "../StanfordCPPLib/map.h"
 
 /**
@@ -20,9 +22,13 @@
  * of the evaluator and contains information from the evaluation
  * environment that the evaluator may need to know.  In this
  * version, the only information maintained by the EvalState class
- * is a symbol table that maps variable names into their values.
- * In your implementation, you may include additional information
- * in the EvalState class.
+ * is the values of variables.
+ * <br> <br>
+ * Every variable name is resolved once, when a statement is parsed, into a
+ * slot: a dense integer shared by all EvalState objects.  The values are
+ * kept in an array indexed by slot with a defined flag per slot, so the
+ * evaluator never hashes or compares names.  The name-based methods are
+ * kept for direct mode and CLEAR.
  */
 class EvalState {
 public:
@@ -54,12 +60,67 @@ public:
     bool isDefined(const std::string& var);
 
     /**
-     * To Clear the Store Data Map
+     * Slot Setting
+     * @param slot the Slot of a Variable
+     * @param value
+     */
+    void setValue(int slot, int value) {
+        if (std::size_t(slot) >= _values.size()) grow(slot);
+        _values[slot] = value;
+        _defined[slot] = true;
+    }
+
+    /**
+     * Slot Getter
+     * @param slot the Slot of a Variable, which MUST be defined
+     * @return The Value of Variable
+     */
+    int getValue(int slot) const {
+        return _values[slot];
+    }
+
+    /**
+     * @param slot the Slot of a Variable
+     * @return whether a Variable is Defined
+     */
+    bool isDefined(int slot) const {
+        return std::size_t(slot) < _defined.size() && _defined[slot];
+    }
+
+    /**
+     * To Clear the Values of every Variable
      */
     void clear();
 
+    /**
+     * Slot of a Variable
+     * @param var variable
+     * @return the Slot of the Variable
+     *
+     * Returns the slot assigned to the name, assigning the next free slot
+     * if the name has not been seen before.
+     */
+    static int getSlot(const std::string &var);
+
+    /**
+     * @param slot
+     * @return the Name of the Variable in the Slot
+     */
+    static const std::string &getName(int slot);
+
+    /**
+     * @return the Number of Slots that have been Assigned
+     */
+    static int getSlotCount();
+
 private:
-    std::map<std::string, int> _symbolTable;
+    void grow(int slot);
+
+    std::vector<int> _values;
+    std::vector<char> _defined;
+
+    static std::unordered_map<std::string, int> _slots;
+    static std::vector<std::string> _names;
 };
 
 #endif
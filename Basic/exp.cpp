@@ -5,6 +5,8 @@
  */
 
 #include <string>
+#include <utility>
+#include <vector>
 #include "evalstate.h"
 #include "exp.h"
 
@@ -18,12 +20,19 @@ Expression::Expression() = default;
 
 Expression::~Expression() = default;
 
-ConstantExp::ConstantExp(int value) {
-    this->value = value;
+std::string operatorToString(Operator op) {
+    switch (op) {
+        case ASSIGN: return "=";
+        case ADD: return "+";
+        case SUBTRACT: return "-";
+        case MULTIPLY: return "*";
+        case DIVIDE: return "/";
+        default: return "";
+    }
 }
 
-int ConstantExp::eval(EvalState &state) {
-    return value;
+ConstantExp::ConstantExp(int value) {
+    this->value = value;
 }
 
 std::string ConstantExp::toString() {
@@ -39,18 +48,13 @@ int ConstantExp::getValue() const {
 }
 
 /**
- * The IdentifierExp subclass declares a single instance variable that
- * stores the name of the variable. The implementation of eval must
- * look this variable up in the evaluation state.
+ * The IdentifierExp subclass declares instance variables for the name of
+ * the variable and its slot in the evaluation state.
  */
 
 IdentifierExp::IdentifierExp(std::string name) {
     this->name = std::move(name);
-}
-
-int IdentifierExp::eval(EvalState &state) {
-    if (!state.isDefined(name)) error("VARIABLE NOT DEFINED");
-    return state.getValue(name);
+    this->slot = EvalState::getSlot(this->name);
 }
 
 std::string IdentifierExp::toString() {
@@ -65,60 +69,62 @@ std::string IdentifierExp::getName() {
     return name;
 }
 
+int IdentifierExp::getSlot() const {
+    return slot;
+}
+
 /**
  * The CompoundExp subclass declares instance variables for the operator
- * and the left and right subexpressions.  The implementation of eval 
- * evaluates the subexpressions recursively and then applies the operator.
+ * and the left and right subexpressions.  The walk of toString keeps its
+ * state on an explicit stack, so that it is not limited by the depth of
+ * the tree.
  */
 
-CompoundExp::CompoundExp(std::string op, Expression *lhs, Expression *rhs) {
-    this->op = std::move(op);
+CompoundExp::CompoundExp(Operator op, Expression *lhs, Expression *rhs) {
+    this->op = op;
     this->lhs = lhs;
     this->rhs = rhs;
 }
 
-CompoundExp::~CompoundExp() {
-    delete lhs;
-    delete rhs;
-}
-
 /**
- * The eval method for the compound expression case must check for the
- * assignment operator as a special case.  Unlike the arithmetic operators
- * the assignment operator does not evaluate its left operand.
+ * Implementation notes: toString
+ * <br>
+ * The text is written into a single string in one walk: "(" on the way
+ * down to the left operand, the operator on the way to the right operand,
+ * and ")" when the node is finished.
  */
-
-int CompoundExp::eval(EvalState &state) {
-    if (op == "=") {
-        if (lhs->getType() != IDENTIFIER) {
-            error("Illegal variable in assignment");
+std::string CompoundExp::toString() {
+    std::string text;
+    std::vector<std::pair<CompoundExp *, bool>> frames;
+    Expression *exp = this;
+    while (true) {
+        while (exp->getType() == COMPOUND) {
+            auto *compound = (CompoundExp *) exp;
+            text += '(';
+            frames.emplace_back(compound, true);
+            exp = compound->lhs;
+        }
+        text += exp->toString();
+        while (true) {
+            if (frames.empty()) return text;
+            auto &frame = frames.back();
+            if (frame.second) {
+                frame.second = false;
+                text += ' ' + operatorToString(frame.first->op) + ' ';
+                exp = frame.first->rhs;
+                break;
+            }
+            text += ')';
+            frames.pop_back();
         }
-        int val = rhs->eval(state);
-        state.setValue(((IdentifierExp *) lhs)->getName(), val);
-        return val;
-    }
-    int left = lhs->eval(state);
-    int right = rhs->eval(state);
-    if (op == "+") return left + right;
-    if (op == "-") return left - right;
-    if (op == "*") return left * right;
-    if (op == "/") {
-        if (right != 0) return left / right;
-        else error("DIVIDE BY ZERO");
     }
-    error("Illegal operator in expression");
-    return 0;
-}
-
-std::string CompoundExp::toString() {
-    return '(' + lhs->toString() + ' ' + op + ' ' + rhs->toString() + ')';
 }
 
 ExpressionType CompoundExp::getType() {
     return COMPOUND;
 }
 
-std::string CompoundExp::getOp() const {
+Operator CompoundExp::getOp() const {
     return op;
 }
 
@@ -21,6 +21,22 @@ enum ExpressionType {
     CONSTANT, IDENTIFIER, COMPOUND
 };
 
+/**
+ * @enum Operator
+ *
+ * This enumerated type lists the operators a CompoundExp may apply.
+ * NO_OPERATOR is used by the parser for a token that is not an operator.
+ */
+enum Operator {
+    NO_OPERATOR, ASSIGN, ADD, SUBTRACT, MULTIPLY, DIVIDE
+};
+
+/**
+ * @param op
+ * @return the Token of the Operator, such as "+"
+ */
+std::string operatorToString(Operator op);
+
 /**
  * @class Expression
  *
@@ -55,8 +71,6 @@ public:
      */
     virtual ~Expression();
 
-    virtual int eval(EvalState &state) = 0;
-
     virtual std::string toString() = 0;
 
     virtual ExpressionType getType() = 0;
@@ -74,8 +88,7 @@ public:
      * @param value
      *
      * The ConstantExp subclass declares a single instance variable that
-     * stores the value of the constant.  The eval method doesn't use the
-     * value of state but needs it to match the general prototype for eval.
+     * stores the value of the constant.
      */
     ConstantExp(int value);
 
@@ -85,8 +98,6 @@ public:
      * These methods have the same prototypes as those in the Expression
      * base class and don't require additional documentation.
      */
-    int eval(EvalState &state) override;
-
     std::string toString() override;
 
     ExpressionType getType() override;
@@ -101,6 +112,7 @@ private:
  * @class IdentifierExp
  *
  * This subclass represents an expression corresponding to a variable.
+ * The slot of the variable is looked up once, when the node is created.
  */
 class IdentifierExp : public Expression {
 public:
@@ -113,23 +125,25 @@ public:
      * These methods have the same prototypes as those in the Expression
      * base class and don't require additional documentation.
      */
-    int eval(EvalState &state) override;
-
     std::string toString() override;
 
     ExpressionType getType() override;
 
     std::string getName();
 
+    int getSlot() const;
+
 private:
     std::string name;
+    int slot;
 };
 
 /**
  * @class CompoundExp
  *
  * This subclass represents a compound expression consisting of
- * two subexpressions joined by an operator.
+ * two subexpressions joined by an operator.  The subexpressions are
+ * owned by the ExpArena the nodes are allocated from, not by this node.
  */
 class CompoundExp : public Expression {
 public:
@@ -143,24 +157,20 @@ public:
      * which is composed of the operator (op) and the left and
      * right subexpression (lhs and rhs).
      */
-    CompoundExp(std::string op, Expression *lhs, Expression *rhs);
-
-    ~CompoundExp() override;
-
-    int eval(EvalState &state) override;
+    CompoundExp(Operator op, Expression *lhs, Expression *rhs);
 
     std::string toString() override;
 
     ExpressionType getType() override;
 
-    std::string getOp() const;
+    Operator getOp() const;
 
     Expression *getLHS() const;
 
     Expression *getRHS() const;
 
 private:
-    std::string op;
+    Operator op;
     Expression *lhs, *rhs;
 };
 
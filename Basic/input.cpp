@@ -0,0 +1,139 @@
+/**
+ * @file input.cpp
+ *
+ * This file implements the InputReader class.
+ */
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "input.h"
+
+InputReader::InputReader(int fd, std::size_t capacity)
+    : _fd(fd), _buffer(new char[capacity]), _capacity(capacity), _pos(_buffer), _end(_buffer) {}
+
+InputReader::~InputReader() {
+    close();
+    delete[] _buffer;
+}
+
+bool InputReader::open(const char *path) {
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    close();
+    _fd = fd;
+    _ownsFd = true;
+    _pos = _end = _buffer;
+    return true;
+}
+
+void InputReader::tie(OutputBuffer *out) {
+    _tie = out;
+}
+
+bool InputReader::readLine(std::string &line) {
+    line.clear();
+    bool readAny = false;
+    while (true) {
+        if (_pos == _end && !fill()) return readAny;
+        readAny = true;
+        auto *newline = (const char *) std::memchr(_pos, '\n', _end - _pos);
+        if (newline != nullptr) {
+            line.append(_pos, newline - _pos);
+            _pos = newline + 1;
+            return true;
+        }
+        line.append(_pos, _end - _pos);
+        _pos = _end;
+    }
+}
+
+bool InputReader::readInteger(int &value) {
+    int ch = peek();
+    while (ch == ' ' || ch == '\t' || ch == '\n' || ch == '\v' || ch == '\f' || ch == '\r') {
+        ++_pos;
+        ch = peek();
+    }
+
+    bool negative = false;
+    if (ch == '+' || ch == '-') {
+        negative = ch == '-';
+        ++_pos;
+        ch = peek();
+    }
+    if (ch < '0' || ch > '9') return false;
+
+    // The magnitude may reach -(long long) INT_MIN before the sign applies.
+    long long magnitude = 0;
+    bool overflow = false;
+    while (ch >= '0' && ch <= '9') {
+        magnitude = magnitude * 10 + (ch - '0');
+        if (magnitude > (long long) INT_MAX + 1) {
+            overflow = true;
+            magnitude = (long long) INT_MAX + 1;
+        }
+        ++_pos;
+        ch = peek();
+    }
+    if (overflow || (!negative && magnitude > INT_MAX)) return false;
+
+    while (ch == ' ') {
+        ++_pos;
+        ch = peek();
+    }
+    if (ch == '\n') {
+        ++_pos;
+    } else if (ch != -1) {
+        return false;
+    }
+    value = negative ? int(-magnitude) : int(magnitude);
+    return true;
+}
+
+void InputReader::skipLine() {
+    while (true) {
+        if (_pos == _end && !fill()) return;
+        auto *newline = (const char *) std::memchr(_pos, '\n', _end - _pos);
+        if (newline != nullptr) {
+            _pos = newline + 1;
+            return;
+        }
+        _pos = _end;
+    }
+}
+
+bool InputReader::atEnd() {
+    return peek() == -1;
+}
+
+bool InputReader::fill() {
+    if (_tie != nullptr) _tie->flush();
+    while (true) {
+        ssize_t count = ::read(_fd, _buffer, _capacity);
+        if (count < 0 && errno == EINTR) continue;
+        if (count <= 0) {
+            _pos = _end = _buffer;
+            return false;
+        }
+        _pos = _buffer;
+        _end = _buffer + count;
+        return true;
+    }
+}
+
+void InputReader::close() {
+    if (_ownsFd) ::close(_fd);
+    _ownsFd = false;
+}
+
+InputReader &inputReader() {
+    static InputReader stdinReader;
+    static bool tied = false;
+    if (!tied) {
+        stdinReader.tie(&output());
+        tied = true;
+    }
+    return stdinReader;
+}
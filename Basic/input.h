@@ -0,0 +1,109 @@
+/**
+ * @file input.h
+ *
+ * This interface exports the InputReader class, from which the REPL reads
+ * its lines and INPUT reads its values.
+ */
+
+#ifndef _input_h
+#define _input_h
+
+#include <cstddef>
+#include <string>
+#include "output.h"
+
+/**
+ * @class InputReader
+ *
+ * The reader pulls large chunks from a file descriptor into a buffer and
+ * scans lines and integers out of the buffer by hand, without iostream.
+ * Like std::cin, it can be tied to an OutputBuffer, which is then flushed
+ * right before the reader has to wait for more input; prompts are visible
+ * whenever the user is asked for something, while a program fed from a
+ * file or a pipe never flushes on its account.
+ */
+class InputReader {
+public:
+    /**
+     * @param fd The File Descriptor to Read from
+     * @param capacity The Size of the Buffer
+     */
+    explicit InputReader(int fd = 0, std::size_t capacity = 1 << 16);
+
+    ~InputReader();
+
+    InputReader(const InputReader &) = delete;
+
+    InputReader &operator=(const InputReader &) = delete;
+
+    /**
+     * Open
+     * @param path
+     * @return whether the File could be Opened
+     *
+     * Reads from the file from now on, instead of the current source.
+     */
+    bool open(const char *path);
+
+    /**
+     * @param out The Output to Flush before Waiting for Input, or nullptr
+     */
+    void tie(OutputBuffer *out);
+
+    /**
+     * Read a Line
+     * @param line Receives the Line without its '\n'
+     * @return false if the input has ended before any character is read
+     */
+    bool readLine(std::string &line);
+
+    /**
+     * Read an Integer
+     * @param value Receives the Integer
+     * @return whether a Valid Integer was Read
+     *
+     * The same rules as reading an int from std::cin and checking the rest
+     * of the line apply: whitespace, including empty lines, is skipped; an
+     * optional sign and at least one digit must follow, and the value must
+     * fit in an int; then only spaces may follow up to the end of the line,
+     * which is consumed.  The end of the input is accepted as the end of
+     * the line.  On failure, the reader stops where the number stopped
+     * making sense, and skipLine() discards the rest of the line.
+     */
+    bool readInteger(int &value);
+
+    /**
+     * Discards everything up to and including the next '\n'.
+     */
+    void skipLine();
+
+    /**
+     * @return whether the Input has Ended
+     */
+    bool atEnd();
+
+private:
+    int peek() {
+        if (_pos == _end && !fill()) return -1;
+        return (unsigned char) *_pos;
+    }
+
+    bool fill();
+
+    void close();
+
+    int _fd;
+    bool _ownsFd = false;
+    char *_buffer;
+    std::size_t _capacity;
+    const char *_pos;
+    const char *_end;
+    OutputBuffer *_tie = nullptr;
+};
+
+/**
+ * @return the Reader of the Standard Input, tied to output()
+ */
+InputReader &inputReader();
+
+#endif
@@ -0,0 +1,430 @@
+/**
+ * @file jit.cpp
+ *
+ * This file implements the NativeCode class.
+ */
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include "jit.h"
+#include "output.h"
+#include "statement.h"
+
+#include "../StanfordCPPLib/error.h"
+
+#if defined(BASIC_JIT) && defined(__x86_64__) && defined(__linux__)
+#define NATIVE_SUPPORTED 1
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define NATIVE_SUPPORTED 0
+#endif
+
+/** The message of the last error caught by a helper */
+static std::string helperMessage;
+
+#if NATIVE_SUPPORTED
+
+static void printValue(int value) {
+    output().writeNumber(value);
+    output().endLine();
+}
+
+/**
+ * Implementation notes: readValue
+ * <br>
+ * An error is caught here and turned into a status, since an exception
+ * cannot be unwound through native frames.
+ */
+static int readValue(int *target) {
+    try {
+        *target = readInputValue();
+        return NATIVE_HALT;
+    } catch (ErrorException &ex) {
+        helperMessage = ex.getMessage();
+        return NATIVE_HELPER_ERROR;
+    }
+}
+
+namespace {
+
+/**
+ * The places native code jumps to besides the instructions themselves.
+ */
+enum Stub {
+    STUB_UNDEFINED = -1,
+    STUB_DIVIDE_BY_ZERO = -2,
+    STUB_EXIT = -3
+};
+
+/**
+ * @class Assembler
+ *
+ * Emits the few x86-64 instructions the templates need.  The register
+ * file is addressed from rbx and the defined flags from rbp; eax and ecx
+ * hold values.  Jumps have 32-bit displacements, patched by link() once
+ * every target is known.
+ */
+class Assembler {
+public:
+    std::vector<unsigned char> bytes;
+
+    void byte(int value) {
+        bytes.push_back((unsigned char) value);
+    }
+
+    void dword(std::int32_t value) {
+        for (int i = 0; i < 4; ++i) byte(value >> (8 * i));
+    }
+
+    void qword(std::uint64_t value) {
+        for (int i = 0; i < 8; ++i) byte(int(value >> (8 * i)));
+    }
+
+    /** op r32, [rbx + 4 * reg], where r is eax (0) or ecx (1) */
+    void registerOperand(int opcode, int r, int reg) {
+        byte(opcode);
+        byte(0x83 | (r << 3));
+        dword(4 * reg);
+    }
+
+    /** jmp or jcc to an instruction index or a Stub */
+    void jump(int condition, int target) {
+        if (condition < 0) {
+            byte(0xE9);
+        } else {
+            byte(0x0F);
+            byte(0x80 | condition);
+        }
+        _fixups.push_back({bytes.size(), target});
+        dword(0);
+    }
+
+    void call(const void *function) {
+        byte(0x48);
+        byte(0xB8);
+        qword((std::uint64_t) function);
+        byte(0xFF);
+        byte(0xD0);
+    }
+
+    /**
+     * @param instructions The Offset of Every Instruction
+     * @param stubs The Offsets of STUB_UNDEFINED, STUB_DIVIDE_BY_ZERO and STUB_EXIT
+     */
+    void link(const std::vector<std::size_t> &instructions, const std::size_t stubs[3]) {
+        for (auto &fixup : _fixups) {
+            std::size_t target = fixup.target >= 0 ? instructions[fixup.target] : stubs[-fixup.target - 1];
+            std::int32_t displacement = std::int32_t(target - (fixup.position + 4));
+            std::memcpy(&bytes[fixup.position], &displacement, 4);
+        }
+    }
+
+private:
+    struct Fixup {
+        std::size_t position;
+        int target;
+    };
+
+    std::vector<Fixup> _fixups;
+};
+
+const int EAX = 0, ECX = 1;
+const int JE = 0x4, JNE = 0x5, JL = 0xC, JG = 0xF, JMP = -1;
+
+/**
+ * @class Translator
+ *
+ * Translates the instructions one by one.  Within a run of instructions
+ * that no jump enters, a variable which has been checked or written is
+ * known to be defined and is not checked again; at a jump target only the
+ * variables defined when the code starts are known.
+ */
+class Translator {
+public:
+    Translator(const RegisterCode &code, const std::vector<char> &defined)
+        : _code(code), _isConstant(code.registerCount, false), _value(code.registerCount, 0),
+          _initiallyKnown(defined.begin(), defined.begin() + code.variableCount) {
+        for (auto &constant : code.constants) {
+            _isConstant[constant.first] = true;
+            _value[constant.first] = constant.second;
+        }
+    }
+
+    std::vector<unsigned char> translate();
+
+private:
+    void load(int r, int reg);
+
+    void check(int reg);
+
+    void store(int reg);
+
+    void markDefined(int reg);
+
+    void arithmetic(const RegInstruction &ins);
+
+    const RegisterCode &_code;
+    Assembler _asm;
+    std::vector<char> _isConstant;
+    std::vector<int> _value;
+    std::vector<char> _initiallyKnown;
+    std::vector<char> _known;
+};
+
+void Translator::load(int r, int reg) {
+    if (_isConstant[reg]) {
+        _asm.byte(0xB8 + r);
+        _asm.dword(_value[reg]);
+    } else {
+        _asm.registerOperand(0x8B, r, reg);
+    }
+}
+
+void Translator::check(int reg) {
+    if (reg >= _code.variableCount || _known[reg]) return;
+    _asm.byte(0x80);          // cmp byte [rbp + reg], 0
+    _asm.byte(0xBD);
+    _asm.dword(reg);
+    _asm.byte(0);
+    _asm.jump(JE, STUB_UNDEFINED);
+    _known[reg] = true;
+}
+
+void Translator::store(int reg) {
+    _asm.registerOperand(0x89, EAX, reg);
+    markDefined(reg);
+}
+
+void Translator::markDefined(int reg) {
+    if (reg >= _code.variableCount || _known[reg]) return;
+    _asm.byte(0xC6);          // mov byte [rbp + reg], 1
+    _asm.byte(0x85);
+    _asm.dword(reg);
+    _asm.byte(1);
+    _known[reg] = true;
+}
+
+void Translator::arithmetic(const RegInstruction &ins) {
+    check(ins.a);
+    check(ins.b);
+    load(EAX, ins.a);
+    bool constant = _isConstant[ins.b];
+    switch (ins.op) {
+        case REG_ADD:
+            if (constant) {
+                _asm.byte(0x05);
+                _asm.dword(_value[ins.b]);
+            } else {
+                _asm.registerOperand(0x03, EAX, ins.b);
+            }
+            break;
+        case REG_SUB:
+            if (constant) {
+                _asm.byte(0x2D);
+                _asm.dword(_value[ins.b]);
+            } else {
+                _asm.registerOperand(0x2B, EAX, ins.b);
+            }
+            break;
+        case REG_MUL:
+            if (constant) {
+                _asm.byte(0x69);      // imul eax, eax, imm32
+                _asm.byte(0xC0);
+                _asm.dword(_value[ins.b]);
+            } else {
+                _asm.byte(0x0F);
+                _asm.registerOperand(0xAF, EAX, ins.b);
+            }
+            break;
+        case REG_DIV:
+            if (constant && _value[ins.b] == 0) {
+                _asm.jump(JMP, STUB_DIVIDE_BY_ZERO);
+                return;
+            }
+            load(ECX, ins.b);
+            if (!constant) {
+                _asm.byte(0x85);      // test ecx, ecx
+                _asm.byte(0xC9);
+                _asm.jump(JE, STUB_DIVIDE_BY_ZERO);
+            }
+            _asm.byte(0x99);          // cdq
+            _asm.byte(0xF7);          // idiv ecx
+            _asm.byte(0xF9);
+            break;
+        default:
+            break;
+    }
+    store(ins.dst);
+}
+
+/**
+ * Implementation notes: translate
+ * <br>
+ * The generated function is int f(int *registers, char *defined), with
+ * registers kept in rbx and defined in rbp.  After the prologue the stack
+ * is aligned for the calls to the helpers.
+ */
+std::vector<unsigned char> Translator::translate() {
+    const std::vector<RegInstruction> &code = _code.code;
+    std::vector<char> isTarget(code.size(), false);
+    for (const RegInstruction &ins : code) {
+        if (ins.op >= REG_JUMP && ins.op <= REG_JUMP_EQUAL) isTarget[ins.dst] = true;
+    }
+
+    // push rbx; push rbp; sub rsp, 8; mov rbx, rdi; mov rbp, rsi
+    for (int b : {0x53, 0x55, 0x48, 0x83, 0xEC, 0x08, 0x48, 0x89, 0xFB, 0x48, 0x89, 0xF5}) _asm.byte(b);
+
+    std::vector<std::size_t> offsets(code.size());
+    _known = _initiallyKnown;
+    for (std::size_t i = 0; i < code.size(); ++i) {
+        const RegInstruction &ins = code[i];
+        offsets[i] = _asm.bytes.size();
+        if (isTarget[i]) _known = _initiallyKnown;
+        switch (ins.op) {
+            case REG_MOVE:
+                check(ins.a);
+                load(EAX, ins.a);
+                store(ins.dst);
+                break;
+            case REG_ADD:
+            case REG_SUB:
+            case REG_MUL:
+            case REG_DIV:
+                arithmetic(ins);
+                break;
+            case REG_CHECK:
+                check(ins.a);
+                break;
+            case REG_JUMP:
+                _asm.jump(JMP, ins.dst);
+                break;
+            case REG_JUMP_LESS:
+            case REG_JUMP_GREATER:
+            case REG_JUMP_EQUAL: {
+                check(ins.a);
+                check(ins.b);
+                load(EAX, ins.a);
+                if (_isConstant[ins.b]) {
+                    _asm.byte(0x3D);  // cmp eax, imm32
+                    _asm.dword(_value[ins.b]);
+                } else {
+                    _asm.registerOperand(0x3B, EAX, ins.b);
+                }
+                int condition = ins.op == REG_JUMP_LESS ? JL : ins.op == REG_JUMP_GREATER ? JG : JE;
+                _asm.jump(condition, ins.dst);
+                break;
+            }
+            case REG_PRINT:
+                check(ins.a);
+                load(EAX, ins.a);
+                _asm.byte(0x89);      // mov edi, eax
+                _asm.byte(0xC7);
+                _asm.call((const void *) &printValue);
+                break;
+            case REG_INPUT:
+                _asm.byte(0x48);      // lea rdi, [rbx + 4 * dst]
+                _asm.byte(0x8D);
+                _asm.byte(0xBB);
+                _asm.dword(4 * ins.dst);
+                _asm.call((const void *) &readValue);
+                _asm.byte(0x85);      // test eax, eax
+                _asm.byte(0xC0);
+                _asm.jump(JNE, STUB_EXIT);
+                markDefined(ins.dst);
+                break;
+            case REG_FAIL:
+                _asm.byte(0xB8);      // mov eax, NATIVE_MESSAGE + index
+                _asm.dword(NATIVE_MESSAGE + ins.a);
+                _asm.jump(JMP, STUB_EXIT);
+                break;
+            case REG_EXIT:
+                _asm.byte(0xB8);      // mov eax, -1 - line
+                _asm.dword(-1 - ins.dst);
+                _asm.jump(JMP, STUB_EXIT);
+                break;
+            case REG_HALT:
+                _asm.byte(0x31);      // xor eax, eax
+                _asm.byte(0xC0);
+                _asm.jump(JMP, STUB_EXIT);
+                break;
+        }
+    }
+
+    std::size_t stubs[3];
+    stubs[0] = _asm.bytes.size();
+    _asm.byte(0xB8);
+    _asm.dword(NATIVE_UNDEFINED);
+    _asm.jump(JMP, STUB_EXIT);
+    stubs[1] = _asm.bytes.size();
+    _asm.byte(0xB8);
+    _asm.dword(NATIVE_DIVIDE_BY_ZERO);
+    stubs[2] = _asm.bytes.size();
+    // add rsp, 8; pop rbp; pop rbx; ret
+    for (int b : {0x48, 0x83, 0xC4, 0x08, 0x5D, 0x5B, 0xC3}) _asm.byte(b);
+
+    _asm.link(offsets, stubs);
+    return std::move(_asm.bytes);
+}
+
+} // namespace
+
+NativeCode::NativeCode(const RegisterCode &code, const std::vector<char> &defined)
+        : _code(code), _defined(defined) {
+    std::vector<unsigned char> bytes = Translator(code, defined).translate();
+    long page = sysconf(_SC_PAGESIZE);
+    std::size_t size = (bytes.size() + page - 1) / page * page;
+    void *memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (memory == MAP_FAILED) return;
+    std::memcpy(memory, bytes.data(), bytes.size());
+    if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(memory, size);
+        return;
+    }
+    _memory = memory;
+    _size = size;
+}
+
+NativeCode::~NativeCode() {
+    if (_memory != nullptr) munmap(_memory, _size);
+}
+
+int NativeCode::run(int *registers, char *defined) const {
+    auto entry = (int (*)(int *, char *)) _memory;
+    return entry(registers, defined);
+}
+
+#else
+
+NativeCode::NativeCode(const RegisterCode &code, const std::vector<char> &defined)
+        : _code(code), _defined(defined) {}
+
+NativeCode::~NativeCode() = default;
+
+int NativeCode::run(int *, char *) const {
+    error("NATIVE CODE NOT SUPPORTED");
+    return NATIVE_HALT;
+}
+
+#endif
+
+bool NativeCode::isReady() const {
+    return _memory != nullptr;
+}
+
+bool NativeCode::isValidFor(const std::vector<char> &defined) const {
+    for (int slot : _code.variables) {
+        if (_defined[slot] && !defined[slot]) return false;
+    }
+    return true;
+}
+
+std::string NativeCode::getMessage(int status) const {
+    switch (status) {
+        case NATIVE_UNDEFINED: return "VARIABLE NOT DEFINED";
+        case NATIVE_DIVIDE_BY_ZERO: return "DIVIDE BY ZERO";
+        case NATIVE_HELPER_ERROR: return helperMessage;
+        default: return _code.messages[status - NATIVE_MESSAGE];
+    }
+}
@@ -0,0 +1,95 @@
+/**
+ * @file jit.h
+ *
+ * This interface exports NativeCode, which translates RegisterCode into
+ * x86-64 machine code on Linux.
+ */
+
+#ifndef _jit_h
+#define _jit_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "regcode.h"
+
+/**
+ * @enum NativeStatus
+ *
+ * How native code stops.  Generated code never throws: an error makes it
+ * return a status, from which the caller reports the message once the
+ * native frames are gone.  A status of NATIVE_MESSAGE + i stands for
+ * messages[i] of the register code, and a status of -1 - n for an EXIT to
+ * line n.
+ */
+enum NativeStatus {
+    NATIVE_HALT,
+    NATIVE_UNDEFINED,
+    NATIVE_DIVIDE_BY_ZERO,
+    NATIVE_HELPER_ERROR,
+    NATIVE_MESSAGE
+};
+
+/**
+ * @class NativeCode
+ *
+ * Each register instruction is translated by a fixed template into
+ * straight-line code in a buffer mapped with mmap, which is made
+ * executable, and no longer writable, once it is complete.  Registers
+ * are read and written at fixed offsets from a base register, constants
+ * become immediates, and PRINT and INPUT call back into C++ helpers.
+ * <br>
+ * Native code generation is only built when BASIC_JIT is defined, for
+ * Linux on x86-64; elsewhere, or if the buffer cannot be mapped,
+ * isReady() is false and the caller interprets the register code.
+ */
+class NativeCode {
+public:
+    /**
+     * @param code The Register Code to Translate, which must Outlive this Object
+     * @param defined Which Registers are Defined when the Code Starts
+     *
+     * A variable defined when the code starts never needs to be checked.
+     */
+    NativeCode(const RegisterCode &code, const std::vector<char> &defined);
+
+    ~NativeCode();
+
+    NativeCode(const NativeCode &) = delete;
+
+    NativeCode &operator=(const NativeCode &) = delete;
+
+    /**
+     * @return whether the Code has been Translated
+     */
+    bool isReady() const;
+
+    /**
+     * @param defined Which Registers are Defined Now
+     * @return whether every Variable Defined when the Code was Translated
+     *         still is, as the Code does not Check those
+     */
+    bool isValidFor(const std::vector<char> &defined) const;
+
+    /**
+     * Run
+     * @param registers The Register File
+     * @param defined The Defined Flag of Every Register
+     * @return a NativeStatus
+     */
+    int run(int *registers, char *defined) const;
+
+    /**
+     * @param status A Status other than NATIVE_HALT
+     * @return the Error Message of the Status
+     */
+    std::string getMessage(int status) const;
+
+private:
+    const RegisterCode &_code;
+    std::vector<char> _defined;
+    void *_memory = nullptr;
+    std::size_t _size = 0;
+};
+
+#endif
@@ -0,0 +1,93 @@
+/**
+ * @file keyword.cpp
+ *
+ * This file implements the keyword recognizer.
+ */
+
+#include "keyword.h"
+
+/**
+ * Implementation notes: the keyword table
+ * <br>
+ * The keywords are recognized through a perfect hash: every keyword lands
+ * in a slot of its own, so a word is a keyword exactly when it equals the
+ * one in its slot.  The hash mixes the first two characters and the
+ * length with a seed, and the seed is searched for by the compiler, so
+ * adding a keyword only takes a line in KEYWORDS below.
+ */
+namespace {
+
+struct KeywordEntry {
+    std::string_view name;
+    Keyword keyword = NOT_KEYWORD;
+};
+
+constexpr KeywordEntry KEYWORDS[] = {
+    {"REM", KEYWORD_REM}, {"LET", KEYWORD_LET}, {"PRINT", KEYWORD_PRINT},
+    {"INPUT", KEYWORD_INPUT}, {"END", KEYWORD_END}, {"GOTO", KEYWORD_GOTO},
+    {"IF", KEYWORD_IF}, {"THEN", KEYWORD_THEN}, {"RUN", KEYWORD_RUN},
+    {"LIST", KEYWORD_LIST}, {"CLEAR", KEYWORD_CLEAR}, {"QUIT", KEYWORD_QUIT},
+    {"HELP", KEYWORD_HELP}
+};
+
+constexpr unsigned KEYWORD_COUNT = sizeof(KEYWORDS) / sizeof(KEYWORDS[0]);
+constexpr unsigned TABLE_SIZE = 32;
+constexpr unsigned MAX_SEED = 1u << 16;
+constexpr std::size_t MIN_LENGTH = 2;
+constexpr std::size_t MAX_LENGTH = 5;
+
+constexpr unsigned hash(std::string_view word, unsigned seed) {
+    return ((unsigned char) word[0] + (unsigned char) word[1] * seed
+            + unsigned(word.size()) * (seed >> 4)) % TABLE_SIZE;
+}
+
+constexpr bool isPerfect(unsigned seed) {
+    bool used[TABLE_SIZE] = {};
+    for (const KeywordEntry &entry : KEYWORDS) {
+        unsigned slot = hash(entry.name, seed);
+        if (used[slot]) return false;
+        used[slot] = true;
+    }
+    return true;
+}
+
+constexpr unsigned findSeed() {
+    for (unsigned seed = 1; seed < MAX_SEED; ++seed) {
+        if (isPerfect(seed)) return seed;
+    }
+    return 0;
+}
+
+constexpr bool lengthsInRange() {
+    for (const KeywordEntry &entry : KEYWORDS) {
+        if (entry.name.size() < MIN_LENGTH || entry.name.size() > MAX_LENGTH) return false;
+    }
+    return true;
+}
+
+constexpr unsigned SEED = findSeed();
+
+static_assert(KEYWORD_COUNT == KEYWORD_HELP, "every Keyword needs an entry in KEYWORDS");
+static_assert(KEYWORD_COUNT <= TABLE_SIZE, "TABLE_SIZE is too small for the keywords");
+static_assert(lengthsInRange(), "MIN_LENGTH and MAX_LENGTH must cover every keyword");
+static_assert(SEED != 0, "no perfect hash found; the keywords must be distinct");
+
+struct KeywordTable {
+    KeywordEntry slots[TABLE_SIZE];
+
+    constexpr KeywordTable() : slots() {
+        for (const KeywordEntry &entry : KEYWORDS) {
+            slots[hash(entry.name, SEED)] = entry;
+        }
+    }
+};
+
+constexpr KeywordTable TABLE;
+
+}
+
+Keyword toKeyword(std::string_view word) {
+    if (word.size() < MIN_LENGTH || word.size() > MAX_LENGTH) return NOT_KEYWORD;
+    const KeywordEntry &entry = TABLE.slots[hash(word, SEED)];
+    return entry.name == word ? entry.keyword : NOT_KEYWORD;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file keyword.h
+ *
+ * This interface exports the reserved words of BASIC and a function that
+ * recognizes them.
+ */
+
+#ifndef _keyword_h
+#define _keyword_h
+
+#include <string_view>
+
+/**
+ * @enum Keyword
+ *
+ * NOT_KEYWORD is returned for every word that is not reserved.
+ */
+enum Keyword {
+    NOT_KEYWORD,
+    KEYWORD_REM, KEYWORD_LET, KEYWORD_PRINT, KEYWORD_INPUT, KEYWORD_END,
+    KEYWORD_GOTO, KEYWORD_IF, KEYWORD_THEN, KEYWORD_RUN, KEYWORD_LIST,
+    KEYWORD_CLEAR, KEYWORD_QUIT, KEYWORD_HELP
+};
+
+/**
+ * Recognize a Keyword
+ * @param word
+ * @return the Keyword, or NOT_KEYWORD if the word is not reserved
+ *
+ * Keywords are upper case only, so "let" is not a keyword.
+ */
+Keyword toKeyword(std::string_view word);
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file lexer.cpp
+ *
+ * This file implements the Lexer class.
+ */
+
+#include <climits>
+#include "lexer.h"
+
+static bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r';
+}
+
+static bool isDigitChar(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static bool isWordChar(char c) {
+    return (c >= '0' && c <= '9') || (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+Lexer::Lexer() = default;
+
+Lexer::Lexer(std::string_view input) : _input(input) {}
+
+void Lexer::setInput(std::string_view input) {
+    _input = input;
+    _pos = 0;
+    _hasLookahead = false;
+}
+
+Token Lexer::nextToken() {
+    if (_hasLookahead) {
+        _hasLookahead = false;
+        return _lookahead;
+    }
+    Token token;
+    scan(token);
+    return token;
+}
+
+const Token &Lexer::peekToken() {
+    if (!_hasLookahead) {
+        scan(_lookahead);
+        _hasLookahead = true;
+    }
+    return _lookahead;
+}
+
+bool Lexer::hasMoreTokens() {
+    return peekToken().kind != TOKEN_END;
+}
+
+std::size_t Lexer::position() const {
+    return _pos;
+}
+
+void Lexer::allowOnly(bool (*allowed)(char), std::size_t from) {
+    _allowed = allowed;
+    _allowedFrom = from;
+}
+
+void Lexer::scan(Token &token) {
+    std::size_t skipped = _pos;
+    while (_pos < _input.size() && isSpace(_input[_pos])) ++_pos;
+    std::size_t start = _pos;
+    token.value = 0;
+    if (_pos == _input.size()) {
+        token.kind = TOKEN_END;
+    } else if (isDigitChar(_input[_pos])) {
+        token.kind = TOKEN_NUMBER;
+        long long value = 0;
+        while (_pos < _input.size() && isDigitChar(_input[_pos])) {
+            value = value * 10 + (_input[_pos] - '0');
+            if (value > INT_MAX) {
+                token.kind = TOKEN_INVALID;
+                value = INT_MAX;
+            }
+            ++_pos;
+        }
+        token.value = int(value);
+    } else if (isWordChar(_input[_pos])) {
+        token.kind = TOKEN_WORD;
+        while (_pos < _input.size() && isWordChar(_input[_pos])) ++_pos;
+    } else {
+        token.kind = TOKEN_OPERATOR;
+        ++_pos;
+    }
+    token.text = _input.substr(start, _pos - start);
+    if (_allowed != nullptr && !isAllowed(skipped, _pos)) token.kind = TOKEN_INVALID;
+}
+
+bool Lexer::isAllowed(std::size_t begin, std::size_t end) const {
+    for (std::size_t i = begin < _allowedFrom ? _allowedFrom : begin; i < end; ++i) {
+        if (!_allowed(_input[i])) return false;
+    }
+    return true;
+}
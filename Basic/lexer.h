@@ -0,0 +1,99 @@
+/**
+ * @file lexer.h
+ *
+ * This interface exports the Lexer class, which divides a line of BASIC
+ * into tokens without copying it.
+ */
+
+#ifndef _lexer_h
+#define _lexer_h
+
+#include <cstddef>
+#include <string_view>
+
+/**
+ * @enum TokenKind
+ *
+ * TOKEN_INVALID is a number too large for an int, or a token containing
+ * or following a character rejected by Lexer::allowOnly.  Every character
+ * that does not start a word or a number is an operator of its own.
+ */
+enum TokenKind {
+    TOKEN_END, TOKEN_WORD, TOKEN_NUMBER, TOKEN_OPERATOR, TOKEN_INVALID
+};
+
+/**
+ * @struct Token
+ *
+ * The text of a token is a view into the line being scanned, so a token
+ * is only valid as long as the line is.  The value of a number is parsed
+ * while it is scanned.
+ */
+struct Token {
+    TokenKind kind = TOKEN_END;
+    std::string_view text;
+    int value = 0;
+};
+
+/**
+ * @class Lexer
+ *
+ * This class scans the tokens of a line one at a time, the same way a
+ * TokenScanner set to ignore whitespace and scan numbers does, except that
+ * numbers are made of digits only.  Scanning never allocates: each token is
+ * a small struct pointing into the line.  One token of lookahead is kept
+ * for the parser.
+ */
+class Lexer {
+public:
+    Lexer();
+
+    explicit Lexer(std::string_view input);
+
+    void setInput(std::string_view input);
+
+    /**
+     * @return the Next Token, which is consumed
+     */
+    Token nextToken();
+
+    /**
+     * @return the Next Token, which is not consumed
+     */
+    const Token &peekToken();
+
+    bool hasMoreTokens();
+
+    /**
+     * @return the Offset in the Input of the First Character not yet Scanned,
+     * which is only meaningful when no token has been peeked
+     */
+    std::size_t position() const;
+
+    /**
+     * Restrict the Characters of the Input
+     * @param allowed Whether a Character is Allowed
+     * @param from The Offset where the Restriction Starts
+     *
+     * From now on, every character at or after the offset, whitespace
+     * included, must be allowed; a token is TOKEN_INVALID if it contains a
+     * rejected character or follows one, so that the line is validated
+     * while it is scanned for parsing.  The restriction applies to tokens
+     * not yet peeked.
+     */
+    void allowOnly(bool (*allowed)(char), std::size_t from = 0);
+
+private:
+    void scan(Token &token);
+
+    bool isAllowed(std::size_t begin, std::size_t end) const;
+
+    std::string_view _input;
+    std::size_t _pos = 0;
+    Token _lookahead;
+    bool _hasLookahead = false;
+    bool (*_allowed)(char) = nullptr;
+    std::size_t _allowedFrom = 0;
+};
+
+#endif
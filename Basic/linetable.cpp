@@ -0,0 +1,400 @@
+/**
+ * @file linetable.cpp
+ *
+ * This file implements the LineTable class.
+ */
+
+#include <iterator>
+#include <limits>
+#include <map>
+#include <utility>
+#include "linetable.h"
+#include "output.h"
+#include "statement.h"
+#include "stats.h"
+
+#include "../StanfordCPPLib/error.h"
+
+#if defined(BASIC_THREADED_DISPATCH) && (defined(__GNUC__) || defined(__clang__))
+#define THREADED_DISPATCH 1
+#else
+#define THREADED_DISPATCH 0
+#endif
+
+#ifndef BASIC_HOT_LOOP_THRESHOLD
+#define BASIC_HOT_LOOP_THRESHOLD 1000
+#endif
+
+/** How many times a jump back is taken before its loop is compiled, or 0 for never */
+static const unsigned HOT_LOOP_THRESHOLD = BASIC_HOT_LOOP_THRESHOLD;
+
+#if THREADED_DISPATCH
+/** The labels of the ops in run(), known once it has been entered */
+static const void *const *labelTable = nullptr;
+#endif
+
+/**
+ * Implementation notes: compile
+ * <br>
+ * Every handler is created and linked first, so that each jump finds its
+ * target when the handlers are filled.
+ */
+void LineTable::compile(Program &program) {
+    _program = &program;
+    _lines.clear();
+    _referrers.clear();
+    _missing = 0;
+    _loops.clear();
+    _labelled = false;
+    _end = LineHandler();
+    _end.lineNumber = std::numeric_limits<int>::max();
+
+    LineHandler **link = &_first;
+    for (auto &line : program.getLines()) {
+        LineHandler &handler = _lines.emplace_hint(_lines.end(), line.first, LineHandler())->second;
+        handler.lineNumber = line.first;
+        *link = &handler;
+        link = &handler.next;
+    }
+    *link = &_end;
+
+    auto handler = _lines.begin();
+    for (auto &line : program.getLines()) {
+        fill((handler++)->second, line.second);
+    }
+}
+
+/**
+ * Implementation notes: update
+ * <br>
+ * A new handler is linked between its neighbours and then resolves the
+ * jumps which were waiting for its line; a removed one leaves those jumps
+ * waiting again.  A replaced line keeps its handler, so jumps to it stay
+ * as they are.
+ */
+void LineTable::update(int lineNumber) {
+    ++statistics().relinkedLines;
+    invalidate(lineNumber);
+    Statement *stmt = _program->getSourceLine(lineNumber);
+    auto line = _lines.find(lineNumber);
+
+    if (line != _lines.end()) {
+        LineHandler &handler = line->second;
+        unlink(handler);
+        if (stmt != nullptr) {
+            fill(handler, stmt);
+            return;
+        }
+        LineHandler *next = handler.next;
+        if (line == _lines.begin()) _first = next;
+        else std::prev(line)->second.next = next;
+        _lines.erase(line);
+        auto waiting = _referrers.equal_range(lineNumber);
+        for (auto jump = waiting.first; jump != waiting.second; ++jump) {
+            jump->second->target = nullptr;
+            ++_missing;
+        }
+        return;
+    }
+
+    if (stmt == nullptr) return;
+    line = _lines.emplace(lineNumber, LineHandler()).first;
+    LineHandler &handler = line->second;
+    handler.lineNumber = lineNumber;
+    auto after = std::next(line);
+    handler.next = after == _lines.end() ? &_end : &after->second;
+    if (line == _lines.begin()) _first = &handler;
+    else std::prev(line)->second.next = &handler;
+    auto waiting = _referrers.equal_range(lineNumber);
+    for (auto jump = waiting.first; jump != waiting.second; ++jump) {
+        jump->second->target = &handler;
+        --_missing;
+    }
+    fill(handler, stmt);
+}
+
+/**
+ * Implementation notes: fill
+ * <br>
+ * Sets everything of the handler but its line number and its place in the
+ * table, and registers its jump, if any, with the line it names.  Nothing
+ * that needs the statement compiled is touched here.
+ */
+void LineTable::fill(LineHandler &handler, Statement *stmt) {
+    handler.stmt = stmt;
+    handler.slot = 0;
+    handler.exp = nullptr;
+    handler.rhs = nullptr;
+    handler.targetLine = -1;
+    handler.target = nullptr;
+    handler.count = 0;
+    handler.loop = nullptr;
+    switch (stmt->getType()) {
+        case REM_STMT:
+            handler.op = LINE_REM;
+            break;
+        case LET_STMT:
+        case PRINT_STMT:
+            handler.op = LINE_COMPILE;
+            break;
+        case INPUT_STMT:
+            handler.op = LINE_INPUT;
+            handler.slot = ((INPUT *) stmt)->getSlot();
+            break;
+        case END_STMT:
+            handler.op = LINE_END;
+            break;
+        case GOTO_STMT:
+            handler.op = LINE_GOTO;
+            handler.targetLine = ((GOTO *) stmt)->getLineNumber();
+            break;
+        case IF_STMT:
+            handler.op = LINE_COMPILE;
+            handler.targetLine = ((IF *) stmt)->getLineNumber();
+            break;
+    }
+    relabel(handler);
+
+    if (handler.targetLine < 0) return;
+    handler.backward = handler.targetLine <= handler.lineNumber;
+    _referrers.emplace(handler.targetLine, &handler);
+    auto target = _lines.find(handler.targetLine);
+    if (target != _lines.end()) handler.target = &target->second;
+    else ++_missing;
+}
+
+/**
+ * Implementation notes: complete
+ * <br>
+ * Compiles the statement of a LINE_COMPILE handler and gives the handler
+ * the op and the expressions of the statement.
+ */
+void LineTable::complete(LineHandler &handler) const {
+    Statement *stmt = handler.stmt;
+    switch (stmt->getType()) {
+        case LET_STMT:
+            handler.op = LINE_LET;
+            handler.slot = ((LET *) stmt)->getSlot();
+            handler.exp = &((LET *) stmt)->getExp();
+            break;
+        case PRINT_STMT:
+            handler.op = LINE_PRINT;
+            handler.exp = &((PRINT *) stmt)->getExp();
+            break;
+        case IF_STMT: {
+            auto *ifStmt = (IF *) stmt;
+            switch (ifStmt->getComparison()) {
+                case LESS_THAN: handler.op = LINE_IF_LESS; break;
+                case GREATER_THAN: handler.op = LINE_IF_GREATER; break;
+                case EQUAL_TO: handler.op = LINE_IF_EQUAL; break;
+            }
+            handler.exp = &ifStmt->getLHS();
+            handler.rhs = &ifStmt->getRHS();
+            break;
+        }
+        default:
+            break;
+    }
+    relabel(handler);
+}
+
+/**
+ * Withdraws the jump of the handler, if any, from the line it names.
+ */
+void LineTable::unlink(LineHandler &handler) {
+    if (handler.targetLine < 0) return;
+    auto jumps = _referrers.equal_range(handler.targetLine);
+    for (auto jump = jumps.first; jump != jumps.second; ++jump) {
+        if (jump->second == &handler) {
+            _referrers.erase(jump);
+            break;
+        }
+    }
+    if (handler.target == nullptr) --_missing;
+}
+
+/**
+ * Implementation notes: invalidate
+ * <br>
+ * Drops every compiled loop that an edit of the line changes: one that
+ * contains it, or for which it becomes, or stops being, the line after
+ * the loop.  The jumps of the loop start counting again, so that it is
+ * compiled anew once it is hot.
+ */
+void LineTable::invalidate(int lineNumber) {
+    for (auto loop = _loops.begin(); loop != _loops.end();) {
+        if (lineNumber < loop->first || lineNumber > loop->exit) {
+            ++loop;
+            continue;
+        }
+        loop->header->op = loop->op;
+        loop->header->loop = nullptr;
+        relabel(*loop->header);
+        auto end = _lines.upper_bound(loop->last);
+        for (auto line = _lines.lower_bound(loop->first); line != end; ++line) {
+            line->second.count = 0;
+        }
+        loop = _loops.erase(loop);
+        ++statistics().invalidatedLoops;
+    }
+}
+
+void LineTable::relabel([[maybe_unused]] LineHandler &handler) const {
+#if THREADED_DISPATCH
+    if (_labelled) handler.label = labelTable[handler.op];
+#endif
+}
+
+/**
+ * Implementation notes: run
+ * <br>
+ * Each handler ends by dispatching the next one itself.  With threaded
+ * dispatch that is an indirect jump to the label stored in the handler,
+ * one per handler, which the branch predictor can learn separately for
+ * every op; the switch fallback funnels all of them through the jump
+ * table of a single switch.  The labels are stored once, by the first
+ * run; afterwards every handler gets its label as it is filled.
+ * <br>
+ * A jump is counted only when it goes back, which the handler knows from
+ * the line it names, so a loop costs one increment per iteration until
+ * it is compiled, and straight-line code nothing.
+ */
+void LineTable::run(EvalState &state) {
+    if (_missing > 0) error("LINE NUMBER ERROR");
+    LineHandler *line = _first;
+
+#if THREADED_DISPATCH
+    static const void *const labels[] = {
+        &&let, &&print, &&input, &&end, &&jump, &&ifLess, &&ifGreater, &&ifEqual, &&rem,
+        &&lazy, &&compiled
+    };
+    if (!_labelled) {
+        labelTable = labels;
+        _labelled = true;
+        for (auto &handler : _lines) relabel(handler.second);
+        relabel(_end);
+    }
+#endif
+
+    auto backward = [&](LineHandler *branch) {
+        if (HOT_LOOP_THRESHOLD != 0 && ++branch->count == HOT_LOOP_THRESHOLD) promote(branch, state);
+        return branch->target;
+    };
+#define JUMP(branch) ((branch)->backward ? backward(branch) : (branch)->target)
+
+#if THREADED_DISPATCH
+#define HANDLER(op, name) name:
+#define DISPATCH() goto *line->label
+    DISPATCH();
+#else
+#define HANDLER(op, name) case op:
+#define DISPATCH() continue
+    while (true) switch (line->op) {
+#endif
+
+    HANDLER(LINE_LET, let) {
+        state.setValue(line->slot, line->exp->eval(state));
+        line = line->next;
+        DISPATCH();
+    }
+    HANDLER(LINE_PRINT, print) {
+        output().writeNumber(line->exp->eval(state));
+        output().endLine();
+        line = line->next;
+        DISPATCH();
+    }
+    HANDLER(LINE_INPUT, input) {
+        state.setValue(line->slot, readInputValue());
+        line = line->next;
+        DISPATCH();
+    }
+    HANDLER(LINE_END, end) {
+        return;
+    }
+    HANDLER(LINE_GOTO, jump) {
+        line = JUMP(line);
+        DISPATCH();
+    }
+    HANDLER(LINE_IF_LESS, ifLess) {
+        int lhs = line->exp->eval(state);
+        line = lhs < line->rhs->eval(state) ? JUMP(line) : line->next;
+        DISPATCH();
+    }
+    HANDLER(LINE_IF_GREATER, ifGreater) {
+        int lhs = line->exp->eval(state);
+        line = lhs > line->rhs->eval(state) ? JUMP(line) : line->next;
+        DISPATCH();
+    }
+    HANDLER(LINE_IF_EQUAL, ifEqual) {
+        int lhs = line->exp->eval(state);
+        line = lhs == line->rhs->eval(state) ? JUMP(line) : line->next;
+        DISPATCH();
+    }
+    HANDLER(LINE_REM, rem) {
+        line = line->next;
+        DISPATCH();
+    }
+    HANDLER(LINE_COMPILE, lazy) {
+        complete(*line);
+        DISPATCH();
+    }
+    HANDLER(LINE_LOOP, compiled) {
+        const CompiledLoop *loop = line->loop;
+        ++statistics().tierTransfers;
+        int next = _machine.run(loop->code, *loop->native, state);
+        if (next < 0) return;
+        line = &_lines.find(next)->second;
+        DISPATCH();
+    }
+
+#if !THREADED_DISPATCH
+    }
+#endif
+#undef HANDLER
+#undef DISPATCH
+#undef JUMP
+}
+
+/**
+ * Implementation notes: promote
+ * <br>
+ * A loop already compiled at the same target is only replaced by a longer
+ * one, such as an outer loop sharing its first line.  Native code is made
+ * for the variables defined now; the machine falls back to the register
+ * code should one of them be undefined when the loop is entered later.
+ * <br>
+ * The loop is compiled in a list of its own and only spliced into _loops,
+ * which keeps it where it is for the native code referring to its register
+ * code, once nothing can fail any more; an error while compiling leaves
+ * the table as it was.
+ */
+void LineTable::promote(LineHandler *branch, EvalState &state) {
+    LineHandler *header = branch->target;
+    if (header->loop != nullptr && header->loop->last >= branch->lineNumber) return;
+
+    std::list<CompiledLoop> compiled(1);
+    CompiledLoop &loop = compiled.front();
+    RegisterCompiler compiler;
+    loop.code = compiler.compileLoop(*_program, header->lineNumber, branch->lineNumber);
+    loop.native = _machine.translate(loop.code, state);
+    loop.header = header;
+    loop.op = header->op;
+    loop.first = header->lineNumber;
+    loop.last = branch->lineNumber;
+    loop.exit = branch->next->lineNumber;
+
+    if (header->loop != nullptr) {
+        loop.op = header->loop->op;
+        for (auto replaced = _loops.begin(); replaced != _loops.end(); ++replaced) {
+            if (&*replaced == header->loop) {
+                _loops.erase(replaced);
+                break;
+            }
+        }
+    }
+    _loops.splice(_loops.end(), compiled);
+    header->op = LINE_LOOP;
+    header->loop = &loop;
+    relabel(*header);
+    ++statistics().hotLoops;
+}
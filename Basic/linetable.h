@@ -0,0 +1,169 @@
+/**
+ * @file linetable.h
+ *
+ * This interface exports the LineTable, the flat array of line handlers
+ * through which Program::run executes a program.
+ */
+
+#ifndef _linetable_h
+#define _linetable_h
+
+#include <list>
+#include <map>
+#include <memory>
+#include <vector>
+#include "evalstate.h"
+#include "jit.h"
+#include "postfix.h"
+#include "program.h"
+#include "regcode.h"
+#include "regvm.h"
+
+/**
+ * @enum LineOp
+ *
+ * What a line handler does.  An IF has a handler for each comparison, so
+ * that no further decision is taken when it runs.  LINE_COMPILE stands for
+ * a line with an expression that has not run yet, and LINE_LOOP replaces
+ * the handler of the first line of a loop once the loop has been compiled.
+ */
+enum LineOp {
+    LINE_LET, LINE_PRINT, LINE_INPUT, LINE_END, LINE_GOTO,
+    LINE_IF_LESS, LINE_IF_GREATER, LINE_IF_EQUAL, LINE_REM, LINE_COMPILE, LINE_LOOP
+};
+
+struct LineHandler;
+
+/**
+ * @struct CompiledLoop
+ *
+ * A hot loop, compiled into register code and translated into native code
+ * where that is supported.  It depends on the lines from first to last and
+ * on which line follows them, where the code exits when it runs past its
+ * end.
+ */
+struct CompiledLoop {
+    RegisterCode code;
+    std::unique_ptr<NativeCode> native;
+    LineHandler *header = nullptr;     // the handler of the first line
+    LineOp op = LINE_REM;              // the op of the header before it was replaced
+    int first = 0;
+    int last = 0;
+    int exit = 0;                      // the line after last, if any
+};
+
+/**
+ * @struct LineHandler
+ *
+ * The compiled form of a line.  The expressions are the ones parsed by the
+ * statement, which must outlive the handler.  Handlers are linked in the
+ * order of the lines, so that one can be added or removed without moving
+ * the others.
+ */
+struct LineHandler {
+    LineOp op = LINE_END;
+    int lineNumber = 0;
+    Statement *stmt = nullptr;
+    int slot = 0;                      // LET, INPUT
+    const PostfixExp *exp = nullptr;   // LET, PRINT, and the left side of IF
+    const PostfixExp *rhs = nullptr;   // the right side of IF
+    int targetLine = -1;               // GOTO, IF
+    bool backward = false;             // GOTO, IF: whether the target is not after this line
+    LineHandler *target = nullptr;     // GOTO, IF: nullptr while the target line is missing
+    unsigned count = 0;                // GOTO, IF: backward jumps taken
+    CompiledLoop *loop = nullptr;      // LOOP
+    LineHandler *next = nullptr;
+    const void *label = nullptr;       // the code of the op, for threaded dispatch
+};
+
+/**
+ * @class LineTable
+ *
+ * The handlers of a program, one per line, in the order of the lines and
+ * followed by an END.  A REM handler only passes control on to the next
+ * one.
+ * <br>
+ * The handler of a LET, a PRINT or an IF is completed the first time it
+ * runs, when its statement is compiled, so that a run only compiles the
+ * lines it reaches.  Jumps are resolved for every line from the start,
+ * since a missing target line is reported before the program runs.
+ *
+ * Dispatch from one handler to the next is direct-threaded with computed
+ * goto when the build defines BASIC_THREADED_DISPATCH and the compiler
+ * supports labels as values, and a switch on the op otherwise.
+ * <br>
+ * Execution is tiered.  Every jump back to an earlier line is counted,
+ * and once one has been taken often enough, the lines from its target to
+ * the jump are compiled by the RegisterCompiler into a loop of their own,
+ * translated into native code if possible.  The handler of the target
+ * then switches into the compiled loop each time it is reached, carrying
+ * the variables over, and the table takes back control where the loop is
+ * left.  A short program thus starts at once, and a long one spends its
+ * time in compiled code.
+ * <br>
+ * The table is kept for as long as the program is, and follows every edit
+ * of a line by update(), which only touches the handler of the line, its
+ * neighbours, the jumps naming it and the compiled loops depending on it.
+ * Running the program again after an edit thus costs no more than the edit
+ * itself, however long the program is.
+ */
+class LineTable {
+public:
+    LineTable() = default;
+
+    LineTable(const LineTable &) = delete;
+
+    LineTable &operator=(const LineTable &) = delete;
+
+    /**
+     * Compile
+     * @param program
+     *
+     * Replaces the handlers with the ones of the program, which must
+     * outlive them.
+     */
+    void compile(Program &program);
+
+    /**
+     * Update
+     * @param lineNumber A Line of the Program which was Added, Replaced or Removed
+     *
+     * Brings the handler of the line in line with the program again.
+     */
+    void update(int lineNumber);
+
+    /**
+     * Run
+     * @param state Evaluation State to Store the Value of Identifiers
+     *
+     * Executes the handlers from the first one until an END.  If a target
+     * line does not exist, LINE NUMBER ERROR is reported before anything
+     * is executed.
+     */
+    void run(EvalState &state);
+
+private:
+    void fill(LineHandler &handler, Statement *stmt);
+
+    void complete(LineHandler &handler) const;
+
+    void unlink(LineHandler &handler);
+
+    void invalidate(int lineNumber);
+
+    void promote(LineHandler *branch, EvalState &state);
+
+    void relabel(LineHandler &handler) const;
+
+    Program *_program = nullptr;
+    std::map<int, LineHandler> _lines;
+    LineHandler _end;
+    LineHandler *_first = &_end;
+    std::multimap<int, LineHandler *> _referrers; // target line number, jump
+    int _missing = 0;                  // jumps whose target line is missing
+    std::list<CompiledLoop> _loops;
+    RegisterMachine _machine;
+    bool _labelled = false;
+};
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * @file optimizer.cpp
+ *
+ * This file implements the optimization passes over expression trees.
+ */
+
+#include <utility>
+#include <vector>
+#include "optimizer.h"
+#include "stats.h"
+
+/**
+ * Implementation notes: Folded
+ * <br>
+ * The result of folding a subtree, together with whether it can fail, or
+ * has a side effect: a subtree can if it reads a variable that may be
+ * undefined, divides, or assigns.  The flag is computed bottom-up while
+ * folding instead of walking the subtree again.
+ */
+struct Folded {
+    Expression *exp;
+    bool canFail;
+};
+
+static bool isConstant(Expression *exp, int value) {
+    return exp->getType() == CONSTANT && ((ConstantExp *) exp)->getValue() == value;
+}
+
+/**
+ * Implementation notes: fold
+ * <br>
+ * Computes the value of an operator applied to two constants.  It returns
+ * false for a division by zero, which must be left to the evaluation.
+ */
+static bool fold(Operator op, int left, int right, int &value) {
+    switch (op) {
+        case ADD: value = left + right; return true;
+        case SUBTRACT: value = left - right; return true;
+        case MULTIPLY: value = left * right; return true;
+        case DIVIDE:
+            if (right == 0) return false;
+            value = left / right;
+            return true;
+        default: return false;
+    }
+}
+
+/**
+ * Implementation notes: simplify
+ * <br>
+ * Stores the expression an identity reduces the operation to in result, or
+ * returns false if no identity applies.
+ */
+static bool simplify(Operator op, const Folded &lhs, const Folded &rhs, ExpArena &arena,
+                     Folded &result) {
+    switch (op) {
+        case ADD:
+            if (isConstant(rhs.exp, 0)) result = lhs;
+            else if (isConstant(lhs.exp, 0)) result = rhs;
+            else return false;
+            return true;
+        case SUBTRACT:
+            if (!isConstant(rhs.exp, 0)) return false;
+            result = lhs;
+            return true;
+        case MULTIPLY:
+            if (isConstant(rhs.exp, 1)) result = lhs;
+            else if (isConstant(lhs.exp, 1)) result = rhs;
+            else if ((isConstant(rhs.exp, 0) && !lhs.canFail) || (isConstant(lhs.exp, 0) && !rhs.canFail)) {
+                result = {arena.make<ConstantExp>(0), false};
+            } else {
+                return false;
+            }
+            return true;
+        case DIVIDE:
+            if (!isConstant(rhs.exp, 1)) return false;
+            result = lhs;
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * Implementation notes: foldConstants
+ * <br>
+ * The tree is folded bottom-up without recursion.  A compound node is
+ * visited twice: the first time it pushes its operands to be folded, and
+ * the second time their results are on top of the result stack, left
+ * below right, and the node itself is folded.  The left operand of an
+ * assignment is never pushed.
+ */
+Expression *foldConstants(Expression *exp, ExpArena &arena) {
+    if (exp->getType() != COMPOUND) return exp;
+    std::vector<std::pair<Expression *, bool>> pending = {{exp, false}};
+    std::vector<Folded> results;
+    while (!pending.empty()) {
+        Expression *node = pending.back().first;
+        if (node->getType() != COMPOUND) {
+            pending.pop_back();
+            results.push_back({node, node->getType() == IDENTIFIER});
+            continue;
+        }
+        auto *compound = (CompoundExp *) node;
+        Operator op = compound->getOp();
+        if (!pending.back().second) {
+            pending.back().second = true;
+            pending.emplace_back(compound->getRHS(), false);
+            if (op != ASSIGN) pending.emplace_back(compound->getLHS(), false);
+            continue;
+        }
+        pending.pop_back();
+
+        Folded rhs = results.back();
+        results.pop_back();
+        if (op == ASSIGN) {
+            if (rhs.exp == compound->getRHS()) results.push_back({compound, true});
+            else results.push_back({arena.make<CompoundExp>(op, compound->getLHS(), rhs.exp), true});
+            continue;
+        }
+        Folded lhs = results.back();
+        results.pop_back();
+
+        int value;
+        Folded simplified;
+        if (lhs.exp->getType() == CONSTANT && rhs.exp->getType() == CONSTANT
+            && fold(op, ((ConstantExp *) lhs.exp)->getValue(), ((ConstantExp *) rhs.exp)->getValue(), value)) {
+            ++statistics().foldedNodes;
+            results.push_back({arena.make<ConstantExp>(value), false});
+        } else if (simplify(op, lhs, rhs, arena, simplified)) {
+            ++statistics().simplifiedNodes;
+            results.push_back(simplified);
+        } else {
+            bool canFail = op == DIVIDE || lhs.canFail || rhs.canFail;
+            if (lhs.exp == compound->getLHS() && rhs.exp == compound->getRHS()) {
+                results.push_back({compound, canFail});
+            } else {
+                results.push_back({arena.make<CompoundExp>(op, lhs.exp, rhs.exp), canFail});
+            }
+        }
+    }
+    return results.back().exp;
+}
@@ -0,0 +1,30 @@
+/**
+ * @file optimizer.h
+ *
+ * This interface exports the optimization passes over expression trees.
+ */
+
+#ifndef _optimizer_h
+#define _optimizer_h
+
+#include "arena.h"
+#include "exp.h"
+
+/**
+ * Fold Constants
+ * @param exp The Root of the Tree Produced by the Parser
+ * @param arena The Arena that Owns the Tree, where new nodes are made
+ * @return the Root of the Simplified Tree
+ *
+ * This function folds every compound subexpression whose operands are
+ * constants into a single ConstantExp, and removes operations that cannot
+ * change their operand: x + 0, 0 + x, x - 0, x * 1, 1 * x and x / 1.
+ * x * 0 and 0 * x become 0 only when x can raise no error and has no side
+ * effect.  A division by the constant 0 and the left operand of an
+ * assignment are never touched, so the evaluation reports exactly the
+ * same errors as the original tree.  The number of folded and removed
+ * nodes is added to statistics().
+ */
+Expression *foldConstants(Expression *exp, ExpArena &arena);
+
+#endif
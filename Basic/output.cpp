@@ -0,0 +1,87 @@
+/**
+ * @file output.cpp
+ *
+ * This file implements the OutputBuffer class.
+ */
+
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include "output.h"
+
+OutputBuffer::OutputBuffer(int fd, std::size_t capacity)
+    : _fd(fd), _buffer(new char[capacity]), _capacity(capacity) {}
+
+OutputBuffer::~OutputBuffer() {
+    flush();
+    delete[] _buffer;
+}
+
+void OutputBuffer::write(std::string_view text) {
+    if (_size + text.size() > _capacity) {
+        flush();
+        if (text.size() > _capacity) {
+            // Too large to be buffered at all: write it through.
+            std::size_t done = 0;
+            while (done < text.size()) {
+                ssize_t written = ::write(_fd, text.data() + done, text.size() - done);
+                if (written < 0 && errno == EINTR) continue;
+                if (written <= 0) return;
+                done += written;
+            }
+            return;
+        }
+    }
+    std::memcpy(_buffer + _size, text.data(), text.size());
+    _size += text.size();
+}
+
+/**
+ * Implementation notes: writeNumber
+ * <br>
+ * The digits are produced backwards into a small array.  The magnitude is
+ * taken as an unsigned number, so that the most negative value prints
+ * correctly.
+ */
+void OutputBuffer::writeNumber(long long value) {
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *begin = end;
+    unsigned long long magnitude = value < 0 ? 0ULL - (unsigned long long) value : value;
+    do {
+        *--begin = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) *--begin = '-';
+    write(std::string_view(begin, end - begin));
+}
+
+void OutputBuffer::endLine() {
+    if (_size == _capacity) flush();
+    _buffer[_size++] = '\n';
+    if (_lineBuffered) flush();
+}
+
+void OutputBuffer::flush() {
+    std::size_t done = 0;
+    while (done < _size) {
+        ssize_t written = ::write(_fd, _buffer + done, _size - done);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) break;
+        done += written;
+    }
+    _size = 0;
+}
+
+void OutputBuffer::setLineBuffered(bool lineBuffered) {
+    _lineBuffered = lineBuffered;
+}
+
+bool OutputBuffer::isLineBuffered() const {
+    return _lineBuffered;
+}
+
+OutputBuffer &output() {
+    static OutputBuffer stdoutBuffer;
+    return stdoutBuffer;
+}
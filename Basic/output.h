@@ -0,0 +1,72 @@
+/**
+ * @file output.h
+ *
+ * This interface exports the OutputBuffer class, through which every
+ * line the interpreter prints is written.
+ */
+
+#ifndef _output_h
+#define _output_h
+
+#include <cstddef>
+#include <string_view>
+
+/**
+ * @class OutputBuffer
+ *
+ * Output is collected in a large user-space buffer and handed to the
+ * operating system with a single write(2) when the buffer is full, when
+ * the interpreter is about to read input, and when a program ends.  In
+ * line-buffered mode, which is meant for interactive use, the buffer is
+ * also flushed at the end of every line.  Numbers are formatted by hand
+ * without the locale machinery of iostream.
+ */
+class OutputBuffer {
+public:
+    /**
+     * @param fd The File Descriptor to Write to
+     * @param capacity The Size of the Buffer
+     */
+    explicit OutputBuffer(int fd = 1, std::size_t capacity = 1 << 16);
+
+    /**
+     * Flushes what is left in the buffer and frees it.
+     */
+    ~OutputBuffer();
+
+    OutputBuffer(const OutputBuffer &) = delete;
+
+    OutputBuffer &operator=(const OutputBuffer &) = delete;
+
+    void write(std::string_view text);
+
+    void writeNumber(long long value);
+
+    /**
+     * Ends the current line, and flushes the buffer in line-buffered mode.
+     */
+    void endLine();
+
+    /**
+     * Hands everything in the buffer to the operating system.
+     */
+    void flush();
+
+    void setLineBuffered(bool lineBuffered);
+
+    bool isLineBuffered() const;
+
+private:
+    int _fd;
+    char *_buffer;
+    std::size_t _size = 0;
+    std::size_t _capacity;
+    bool _lineBuffered = false;
+};
+
+/**
+ * @return the Buffer of the Standard Output
+ */
+OutputBuffer &output();
+
+#endif
@@ -5,50 +5,142 @@
  */
 
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "exp.h"
 #include "parser.h"
 
 #include "../StanfordCPPLib/error.h"
 
-Expression *parseExp(TokenScanner &scanner) {
-    Expression *exp = readE(scanner);
-    if (scanner.hasMoreTokens()) {
+Expression *parseExp(Lexer &lexer, ExpArena &arena) {
+    Expression *exp = readE(lexer, arena);
+    if (lexer.hasMoreTokens()) {
         error("SYNTAX ERROR");
     }
     return exp;
 }
 
-Expression *readE(TokenScanner &scanner, int prec) {
-    Expression *exp = readT(scanner);
-    string token;
+/**
+ * Implementation notes: readE
+ * <br>
+ * The operands read so far and the operators waiting for their right
+ * operand are kept on two explicit stacks, so neither long chains nor
+ * deep parentheses use the native stack.  An open parenthesis is pushed as
+ * NO_OPERATOR; it stops the reduction of the operators below it, and the
+ * precedence of the expression it encloses starts from 0 again.  Before an
+ * operator is pushed, the waiting operators of the same or a higher
+ * precedence are reduced, which makes every operator left-associative,
+ * the same as reading each subexpression recursively would.
+ */
+static void reduce(std::vector<Expression *> &operands, std::vector<Operator> &operators,
+                   ExpArena &arena) {
+    Expression *rhs = operands.back();
+    operands.pop_back();
+    operands.back() = arena.make<CompoundExp>(operators.back(), operands.back(), rhs);
+    operators.pop_back();
+}
+
+Expression *readE(Lexer &lexer, ExpArena &arena, int prec) {
+    std::vector<Expression *> operands;
+    std::vector<Operator> operators;
+    int openParens = 0;
     while (true) {
-        token = scanner.nextToken();
-        int newPrec = precedence(token);
-        if (newPrec <= prec) break;
-        Expression *rhs = readE(scanner, newPrec);
-        exp = new CompoundExp(token, exp, rhs);
+        // Read a term, after any number of open parentheses.
+        Token token = lexer.nextToken();
+        while (token.kind == TOKEN_OPERATOR && token.text == "(") {
+            operators.push_back(NO_OPERATOR);
+            ++openParens;
+            token = lexer.nextToken();
+        }
+        if (token.kind == TOKEN_WORD) {
+            operands.push_back(arena.make<IdentifierExp>(std::string(token.text)));
+        } else if (token.kind == TOKEN_NUMBER) {
+            operands.push_back(arena.make<ConstantExp>(token.value));
+        } else {
+            error("SYNTAX ERROR");
+        }
+
+        // Read the operator after it, closing the parentheses it ends.
+        while (true) {
+            const Token &next = lexer.peekToken();
+            Operator op = next.kind == TOKEN_OPERATOR ? toOperator(next.text) : NO_OPERATOR;
+            int newPrec = precedence(op);
+            if (newPrec > (openParens > 0 ? 0 : prec)) {
+                while (!operators.empty() && precedence(operators.back()) >= newPrec) {
+                    reduce(operands, operators, arena);
+                }
+                operators.push_back(op);
+                lexer.nextToken();
+                break;
+            }
+            while (!operators.empty() && operators.back() != NO_OPERATOR) {
+                reduce(operands, operators, arena);
+            }
+            if (openParens == 0) return operands.back();
+            token = lexer.nextToken();
+            if (token.kind != TOKEN_OPERATOR || token.text != ")") {
+                error("SYNTAX ERROR");
+            }
+            operators.pop_back();
+            --openParens;
+        }
     }
-    scanner.saveToken(token);
-    return exp;
 }
 
-Expression *readT(TokenScanner &scanner) {
-    string token = scanner.nextToken();
-    TokenType type = scanner.getTokenType(token);
-    if (type == WORD) return new IdentifierExp(token);
-    if (type == NUMBER) return new ConstantExp(stringToInteger(token));
-    if (token != "(") error("SYNTAX ERROR");
-    Expression *exp = readE(scanner);
-    if (scanner.nextToken() != ")") {
+void checkExp(Lexer &lexer) {
+    checkE(lexer);
+    if (lexer.hasMoreTokens()) {
         error("SYNTAX ERROR");
     }
-    return exp;
 }
 
-int precedence(const std::string &token) {
-    if (token == "=") return 1;
-    if (token == "+" || token == "-") return 2;
-    if (token == "*" || token == "/") return 3;
-    return 0;
+void checkE(Lexer &lexer, int prec) {
+    int openParens = 0;
+    while (true) {
+        Token token = lexer.nextToken();
+        while (token.kind == TOKEN_OPERATOR && token.text == "(") {
+            ++openParens;
+            token = lexer.nextToken();
+        }
+        if (token.kind != TOKEN_WORD && token.kind != TOKEN_NUMBER) {
+            error("SYNTAX ERROR");
+        }
+
+        while (true) {
+            const Token &next = lexer.peekToken();
+            Operator op = next.kind == TOKEN_OPERATOR ? toOperator(next.text) : NO_OPERATOR;
+            if (precedence(op) > (openParens > 0 ? 0 : prec)) {
+                lexer.nextToken();
+                break;
+            }
+            if (openParens == 0) return;
+            token = lexer.nextToken();
+            if (token.kind != TOKEN_OPERATOR || token.text != ")") {
+                error("SYNTAX ERROR");
+            }
+            --openParens;
+        }
+    }
+}
+
+Operator toOperator(std::string_view token) {
+    if (token.length() != 1) return NO_OPERATOR;
+    switch (token[0]) {
+        case '=': return ASSIGN;
+        case '+': return ADD;
+        case '-': return SUBTRACT;
+        case '*': return MULTIPLY;
+        case '/': return DIVIDE;
+        default: return NO_OPERATOR;
+    }
+}
+
+int precedence(Operator op) {
+    switch (op) {
+        case ASSIGN: return 1;
+        case ADD: case SUBTRACT: return 2;
+        case MULTIPLY: case DIVIDE: return 3;
+        default: return 0;
+    }
 }
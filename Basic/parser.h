@@ -7,52 +7,77 @@
 #ifndef _parser_h
 #define _parser_h
 
-#include <string>
+#include <string_view>
+#include "arena.h"
 #include "exp.h"
-
-#include "../StanfordCPPLib/tokenscanner.h"
+#include "lexer.h"
 
 /**
  * To Parse an Expression
- * @param scanner
+ * @param lexer
+ * @param arena The Arena that Owns the Nodes of the Expression
  * @return Expression Pointer
  *
  * This code just reads an expression and then checks for extra tokens.
  */
-Expression *parseExp(TokenScanner &scanner);
+Expression *parseExp(Lexer &lexer, ExpArena &arena);
 
 /**
  * Read expression
- * @param scanner
+ * @param lexer
+ * @param arena The Arena that Owns the Nodes of the Expression
  * @param prec Priority of operator
  * @return Expression Pointer
  *
  * This version of readE uses precedence to resolve the ambiguity in
- * the grammar.  At each recursive level, the parser reads operators and
- * subexpressions until it finds an operator whose precedence is greater
- * than the prevailing one.  When a higher-precedence operator is found,
- * readE calls itself recursively to read in that subexpression as a unit.
+ * the grammar.  A term is an integer, an identifier, or a parenthesized
+ * subexpression.  The parser reads terms and operators until it finds a
+ * token that is not an operator, or an operator outside the parentheses
+ * whose precedence is not greater than prec, which is left unread.  It
+ * keeps its state on explicit stacks instead of calling itself, so the
+ * length and the nesting of an expression are only limited by memory.
  */
-Expression *readE(TokenScanner &scanner, int prec = 0);
+Expression *readE(Lexer &lexer, ExpArena &arena, int prec = 0);
 
 /**
- * Read Token
- * @param scanner
- * @return Expression Pointer
+ * To Check an Expression
+ * @param lexer
  *
- * This function scans a term, which is either an integer, an identifier,
- * or a parenthesized subexpression.
+ * Reads an expression and checks for extra tokens, the way parseExp does,
+ * without building it.
  */
-Expression *readT(TokenScanner &scanner);
+void checkExp(Lexer &lexer);
 
 /**
- * Precedence
+ * Check expression
+ * @param lexer
+ * @param prec Priority of operator
+ *
+ * Reads an expression the way readE does, stopping at the same token and
+ * reporting SYNTAX ERROR exactly where readE does, but keeping nothing
+ * but the number of open parentheses.  A line can thus be validated when
+ * it is entered and parsed only once it runs.
+ */
+void checkE(Lexer &lexer, int prec = 0);
+
+/**
+ * To Operator
  * @param token
- * @return The Rank of operator
+ * @return The Operator the Token Stands for
  *
  * This function checks the token against each of the defined operators
- * and returns the appropriate precedence value.
+ * and returns NO_OPERATOR if it is none of them.
+ */
+Operator toOperator(std::string_view token);
+
+/**
+ * Precedence
+ * @param op
+ * @return The Rank of operator
+ *
+ * This function returns the appropriate precedence value of an operator,
+ * and 0 for NO_OPERATOR.
  */
-int precedence(const std::string &token);
+int precedence(Operator op);
 
 #endif
@@ -0,0 +1,214 @@
+/**
+ * @file postfix.cpp
+ *
+ * This file implements the PostfixExp class.
+ */
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "postfix.h"
+
+#include "../StanfordCPPLib/error.h"
+
+PostfixExp::PostfixExp() = default;
+
+/**
+ * Implementation notes: PostfixExp
+ * <br>
+ * The tree is walked in evaluation order with an explicit stack of the
+ * compound nodes whose operator is still to be emitted, so that a deep
+ * tree cannot exhaust the native stack.  An assignment whose left operand
+ * is not an identifier fails before its right operand is evaluated; a
+ * constant 0 takes the place of its value, so that the depth of the stack
+ * stays consistent for the operations after it, which are never reached.
+ */
+PostfixExp::PostfixExp(Expression *exp) {
+    std::vector<std::pair<CompoundExp *, bool>> frames;
+    while (true) {
+        while (true) {
+            if (exp->getType() == CONSTANT) {
+                emit(PF_CONST, ((ConstantExp *) exp)->getValue());
+                break;
+            }
+            if (exp->getType() == IDENTIFIER) {
+                emit(PF_LOAD, ((IdentifierExp *) exp)->getSlot());
+                break;
+            }
+            auto *compound = (CompoundExp *) exp;
+            if (compound->getOp() != ASSIGN) {
+                frames.emplace_back(compound, true);
+                exp = compound->getLHS();
+            } else if (compound->getLHS()->getType() == IDENTIFIER) {
+                frames.emplace_back(compound, false);
+                exp = compound->getRHS();
+            } else {
+                emit(PF_ILLEGAL_ASSIGN);
+                emit(PF_CONST, 0);
+                break;
+            }
+        }
+        while (true) {
+            if (frames.empty()) return;
+            auto &frame = frames.back();
+            if (frame.second) {
+                frame.second = false;
+                exp = frame.first->getRHS();
+                break;
+            }
+            CompoundExp *compound = frame.first;
+            frames.pop_back();
+            switch (compound->getOp()) {
+                case ASSIGN:
+                    emit(PF_ASSIGN, ((IdentifierExp *) compound->getLHS())->getSlot());
+                    break;
+                case ADD: emitArithmetic(PF_ADD); break;
+                case SUBTRACT: emitArithmetic(PF_SUB); break;
+                case MULTIPLY: emitArithmetic(PF_MUL); break;
+                case DIVIDE: emitArithmetic(PF_DIV); break;
+                default: error("Illegal operator in expression");
+            }
+        }
+    }
+}
+
+void PostfixExp::emit(PostfixOpCode code, int operand) {
+    _ops.push_back({code, operand});
+    switch (code) {
+        case PF_CONST:
+        case PF_LOAD:
+            if (++_depth > _maxDepth) _maxDepth = _depth;
+            break;
+        case PF_ADD:
+        case PF_SUB:
+        case PF_MUL:
+        case PF_DIV:
+            --_depth;
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * Implementation notes: emitArithmetic
+ * <br>
+ * If the right operand has just been pushed by a single PF_CONST or
+ * PF_LOAD, the push is turned into the operator itself, which reads the
+ * operand directly.  The operand is read at the same point of the
+ * evaluation as before, so an undefined variable is still reported in
+ * the same order.
+ */
+void PostfixExp::emitArithmetic(PostfixOpCode code) {
+    if (!_ops.empty() && (_ops.back().code == PF_CONST || _ops.back().code == PF_LOAD)) {
+        int offset = _ops.back().code == PF_CONST ? PF_ADD_CONST - PF_ADD : PF_ADD_VAR - PF_ADD;
+        _ops.back().code = PostfixOpCode(code + offset);
+        --_depth;
+        return;
+    }
+    emit(code);
+}
+
+/**
+ * Implementation notes: eval
+ * <br>
+ * Most expressions fit in a small stack on the native stack; only the
+ * rare deep one uses a stack on the heap, which is kept for the next deep
+ * expression.  sp always points at the first free element of the stack.
+ * A lone constant or variable, as in "IF I < 100 THEN 10", is answered
+ * before any of that is set up.
+ */
+int PostfixExp::eval(EvalState &state) const {
+    if (_ops.size() == 1) {
+        const PostfixOp &op = _ops[0];
+        if (op.code == PF_CONST) return op.operand;
+        if (op.code == PF_LOAD) {
+            if (!state.isDefined(op.operand)) error("VARIABLE NOT DEFINED");
+            return state.getValue(op.operand);
+        }
+    }
+    const int SMALL_STACK = 32;
+    int small[SMALL_STACK];
+    int *sp = small;
+    if (_maxDepth > SMALL_STACK) {
+        static std::vector<int> large;
+        if (large.size() < std::size_t(_maxDepth)) large.resize(_maxDepth);
+        sp = large.data();
+    }
+
+    for (const PostfixOp *op = _ops.data(), *end = op + _ops.size(); op != end; ++op) {
+        switch (op->code) {
+            case PF_CONST:
+                *sp++ = op->operand;
+                break;
+            case PF_LOAD:
+                if (!state.isDefined(op->operand)) error("VARIABLE NOT DEFINED");
+                *sp++ = state.getValue(op->operand);
+                break;
+            case PF_ADD:
+                --sp;
+                sp[-1] = sp[-1] + sp[0];
+                break;
+            case PF_SUB:
+                --sp;
+                sp[-1] = sp[-1] - sp[0];
+                break;
+            case PF_MUL:
+                --sp;
+                sp[-1] = sp[-1] * sp[0];
+                break;
+            case PF_DIV:
+                --sp;
+                if (sp[0] == 0) error("DIVIDE BY ZERO");
+                sp[-1] = sp[-1] / sp[0];
+                break;
+            case PF_ADD_CONST:
+                sp[-1] = sp[-1] + op->operand;
+                break;
+            case PF_SUB_CONST:
+                sp[-1] = sp[-1] - op->operand;
+                break;
+            case PF_MUL_CONST:
+                sp[-1] = sp[-1] * op->operand;
+                break;
+            case PF_DIV_CONST:
+                if (op->operand == 0) error("DIVIDE BY ZERO");
+                sp[-1] = sp[-1] / op->operand;
+                break;
+            case PF_ADD_VAR:
+                if (!state.isDefined(op->operand)) error("VARIABLE NOT DEFINED");
+                sp[-1] = sp[-1] + state.getValue(op->operand);
+                break;
+            case PF_SUB_VAR:
+                if (!state.isDefined(op->operand)) error("VARIABLE NOT DEFINED");
+                sp[-1] = sp[-1] - state.getValue(op->operand);
+                break;
+            case PF_MUL_VAR:
+                if (!state.isDefined(op->operand)) error("VARIABLE NOT DEFINED");
+                sp[-1] = sp[-1] * state.getValue(op->operand);
+                break;
+            case PF_DIV_VAR: {
+                if (!state.isDefined(op->operand)) error("VARIABLE NOT DEFINED");
+                int right = state.getValue(op->operand);
+                if (right == 0) error("DIVIDE BY ZERO");
+                sp[-1] = sp[-1] / right;
+                break;
+            }
+            case PF_ASSIGN:
+                state.setValue(op->operand, sp[-1]);
+                break;
+            case PF_ILLEGAL_ASSIGN:
+                error("Illegal variable in assignment");
+                break;
+        }
+    }
+    return sp[-1];
+}
+
+const std::vector<PostfixOp> &PostfixExp::getOps() const {
+    return _ops;
+}
+
+int PostfixExp::getMaxDepth() const {
+    return _maxDepth;
+}
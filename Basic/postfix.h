@@ -0,0 +1,79 @@
+/**
+ * @file postfix.h
+ *
+ * This interface exports the PostfixExp class, the flat form in which
+ * statements keep and evaluate their expressions.
+ */
+
+#ifndef _postfix_h
+#define _postfix_h
+
+#include <vector>
+#include "evalstate.h"
+#include "exp.h"
+
+/**
+ * @enum PostfixOpCode
+ *
+ * The operations of a postfix expression.  The operand of PF_CONST is the
+ * constant; the operand of PF_LOAD and PF_ASSIGN is a variable slot.
+ *
+ * An arithmetic operator whose right operand is a constant or a variable
+ * takes it as its operand instead of from the stack: "I + 1" is
+ * PF_LOAD I, PF_ADD_CONST 1.  Such operations are the most common ones by
+ * far, and each of them saves a trip through the evaluation loop.
+ */
+enum PostfixOpCode {
+    PF_CONST,          // push operand
+    PF_LOAD,           // push the variable in slot operand
+    PF_ADD, PF_SUB, PF_MUL, PF_DIV,
+    PF_ADD_CONST, PF_SUB_CONST, PF_MUL_CONST, PF_DIV_CONST,
+    PF_ADD_VAR, PF_SUB_VAR, PF_MUL_VAR, PF_DIV_VAR,
+    PF_ASSIGN,         // store the top into slot operand, but keep it
+    PF_ILLEGAL_ASSIGN  // report an assignment to something not a variable
+};
+
+struct PostfixOp {
+    PostfixOpCode code;
+    int operand;
+};
+
+/**
+ * @class PostfixExp
+ *
+ * An expression compiled into a contiguous array of operations in postfix
+ * order, which is evaluated by a single loop over a value stack.  The
+ * operations are laid out in the order the tree is read, left operand
+ * first except for the right side of an assignment, so the evaluation
+ * reports the errors of the expression in the order they appear, and the
+ * deepest the stack can get is known when the expression is compiled.
+ */
+class PostfixExp {
+public:
+    PostfixExp();
+
+    /**
+     * @param exp The Tree to Compile, which is not needed afterwards
+     */
+    explicit PostfixExp(Expression *exp);
+
+    int eval(EvalState &state) const;
+
+    const std::vector<PostfixOp> &getOps() const;
+
+    /**
+     * @return the Largest Number of Values on the Stack during Evaluation
+     */
+    int getMaxDepth() const;
+
+private:
+    void emit(PostfixOpCode code, int operand = 0);
+
+    void emitArithmetic(PostfixOpCode code);
+
+    std::vector<PostfixOp> _ops;
+    int _depth = 0;
+    int _maxDepth = 0;
+};
+
+#endif
@@ -10,6 +10,12 @@
 
 #include <string>
 #include "program.h"
+#include "output.h"
+#include "bytecode.h"
+#include "linetable.h"
+#include "regcode.h"
+#include "regvm.h"
+#include "vm.h"
 
 Program::Program() = default;
 
@@ -22,16 +28,22 @@ void Program::clear() {
         delete line.second;
     }
     _program.clear();
+    delete _table;
+    _table = nullptr;
 }
 
 void Program::addSourceLine(int lineNumber, Statement *stmt) {
-    _program[lineNumber] = stmt;
+    Statement *&line = _program[lineNumber];
+    delete line;
+    line = stmt;
+    if (_table != nullptr) _table->update(lineNumber);
 }
 
 void Program::removeSourceLine(int lineNumber) {
     if (_program.count(lineNumber)) {
         delete _program[lineNumber];
         _program.erase(lineNumber);
+        if (_table != nullptr) _table->update(lineNumber);
     }
 }
 
@@ -46,11 +58,9 @@ int Program::getFirstLineNumber() {
 }
 
 int Program::getNextLineNumber(int lineNumber) {
-    if (_currentLine == -1) return -1;
-    auto Temp = _program.find(lineNumber);
-    ++Temp;
-    if (Temp == _program.end()) return -1;
-    else return Temp->first;
+    auto next = _program.upper_bound(lineNumber);
+    if (next == _program.end()) return -1;
+    else return next->first;
 }
 
 bool Program::noSuchLine(int lineNumber) {
@@ -63,16 +73,36 @@ void Program::initCurrentLine() {
 }
 
 void Program::nextLine() {
-    _currentLine = getNextLineNumber(_currentLine);
+    if (_currentLine != -1) _currentLine = getNextLineNumber(_currentLine);
 }
 
 void Program::run(EvalState &state) {
-    initCurrentLine();
-    Statement *currentStmt;
-    while (_currentLine != -1) {
-        currentStmt = _program[_currentLine];
-        currentStmt->execute(*this, state);
+    if (_table == nullptr) {
+        _table = new LineTable;
+        _table->compile(*this);
     }
+    _table->run(state);
+}
+
+void Program::runBytecode(EvalState &state) {
+    BytecodeCompiler compiler;
+    Bytecode bytecode = compiler.compile(*this);
+    VirtualMachine vm;
+    vm.run(bytecode, state);
+}
+
+void Program::runRegisters(EvalState &state) {
+    RegisterCompiler compiler;
+    RegisterCode code = compiler.compile(*this);
+    RegisterMachine machine;
+    machine.run(code, state);
+}
+
+void Program::runNative(EvalState &state) {
+    RegisterCompiler compiler;
+    RegisterCode code = compiler.compile(*this);
+    RegisterMachine machine;
+    machine.runNative(code, state);
 }
 
 void Program::goTo(int lineNumber) {
@@ -82,10 +112,17 @@ void Program::goTo(int lineNumber) {
 
 void Program::list() {
     for (auto &line : _program) {
-        std::cout << line.first << " " << *(line.second) << std::endl;
+        output().writeNumber(line.first);
+        output().write(" ");
+        output().write(line.second->getSource());
+        output().endLine();
     }
 }
 
 void Program::end() {
     _currentLine = -1;
 }
+
+const std::map<int, Statement *> &Program::getLines() const {
+    return _program;
+}
@@ -15,6 +15,7 @@
 
 class Statement;
 class EvalState;
+class LineTable;
 
 /**
  * @class Program
@@ -77,9 +78,8 @@ public:
     /**
      * @param lineNumber
      * @return the line number of the first line in the program whose
-     * number is larger than the specified one, which must already exist
-     * in the program.  If no more lines remain, this method returns -1.
-     * Note that the lineNumber MUST be a valid line.
+     * number is larger than the specified one.  If no more lines remain,
+     * this method returns -1.
      */
     int getNextLineNumber(int lineNumber);
 
@@ -94,27 +94,76 @@ public:
      * Initialize the _currentLine.  If the _program is not empty, then the
      * _currentLine will be set to the first line.  If the _program is empty,
      * then the _currentLine will be set to -1.
+     *
+     * The current line is only followed by Statement::execute; run() keeps
+     * its own position in a LineTable.
      */
     void initCurrentLine();
 
     /**
      * Set the _currentLine to next line number.  If the current line is not the
      * end, then the _currentLine will be set to the next line.  Otherwise,
-     * the _currentLine will be set to -1.
+     * the _currentLine will be set to -1.  If it is already -1, as in direct
+     * mode, it does nothing.
      */
     void nextLine();
 
+    /**
+     * @param state
+     *
+     * Executes the program from the first line through its LineTable.
+     * Moving from a line to the next one or to a jump target only follows
+     * pointers between the handlers of the table, and a missing target
+     * line is reported before anything is executed.  The table is
+     * compiled by the first run and afterwards kept up to date line by
+     * line as the program is edited, so a run after an edit does not
+     * compile the whole program again.
+     */
     void run(EvalState &state);
 
+    /**
+     * @param state
+     *
+     * Compiles the whole program into bytecode and runs it on the stack-based
+     * virtual machine.  The output is identical to the one of run().
+     */
+    void runBytecode(EvalState &state);
+
+    /**
+     * @param state
+     *
+     * Compiles the whole program into three-address register code and runs
+     * it on the register machine.  The output is identical to the one of
+     * run().
+     */
+    void runRegisters(EvalState &state);
+
+    /**
+     * @param state
+     *
+     * Compiles the whole program into register code, translates that into
+     * machine code and runs it.  Where native code is not supported, the
+     * register code is interpreted instead.  The output is identical to
+     * the one of run().
+     */
+    void runNative(EvalState &state);
+
     void goTo(int lineNumber);
 
     void list();
 
     void end();
 
+    /**
+     * @return every line of the program, ordered by line number.
+     */
+    const std::map<int, Statement *> &getLines() const;
+
 private:
     std::map<int, Statement *> _program;
 
+    LineTable *_table = nullptr;       // compiled by the first run
+
     int _currentLine = -1;
 };
 
@@ -0,0 +1,303 @@
+/**
+ * @file regcode.cpp
+ *
+ * This file implements the RegisterCompiler class.
+ */
+
+#include <cstddef>
+#include <string>
+#include "regcode.h"
+#include "evalstate.h"
+
+#include "../StanfordCPPLib/error.h"
+
+RegisterCode RegisterCompiler::compile(Program &program) {
+    for (auto &line : program.getLines()) line.second->compile();
+    reset();
+    for (auto &line : program.getLines()) {
+        _lineAddress[line.first] = int(_code.code.size());
+        compileStatement(line.second);
+    }
+    emit(REG_HALT, 0);
+    patchJumps(false);
+    return std::move(_code);
+}
+
+RegisterCode RegisterCompiler::compileLoop(Program &program, int first, int last) {
+    const std::map<int, Statement *> &lines = program.getLines();
+    for (auto line = lines.lower_bound(first); line != lines.end() && line->first <= last; ++line) {
+        line->second->compile();
+    }
+    reset();
+    auto line = lines.lower_bound(first);
+    for (; line != lines.end() && line->first <= last; ++line) {
+        _lineAddress[line->first] = int(_code.code.size());
+        compileStatement(line->second);
+    }
+    if (line == lines.end()) emit(REG_HALT, 0);
+    else emit(REG_EXIT, line->first);
+    patchJumps(true);
+    return std::move(_code);
+}
+
+/**
+ * Implementation notes: reset
+ * <br>
+ * Registers are numbered after the variables known now, so the statements
+ * to compile must have been compiled already: that is when the variables
+ * of their expressions get their slots.
+ */
+void RegisterCompiler::reset() {
+    _code = RegisterCode();
+    _constants.clear();
+    _lineAddress.clear();
+    _exits.clear();
+    _jumps.clear();
+    _temporaries.clear();
+    _code.variableCount = EvalState::getSlotCount();
+    _used.assign(_code.variableCount, false);
+    _code.registerCount = _code.variableCount;
+}
+
+/**
+ * Implementation notes: patchJumps
+ * <br>
+ * A missing line is reported before anything runs, just like Program::run
+ * does.  In a loop, a jump out of it goes to an EXIT appended for its
+ * target line, shared by every jump there.
+ */
+void RegisterCompiler::patchJumps(bool exitOutside) {
+    for (auto &jump : _jumps) {
+        auto target = _lineAddress.find(jump.second);
+        if (target != _lineAddress.end()) {
+            _code.code[jump.first].dst = target->second;
+        } else if (exitOutside) {
+            _code.code[jump.first].dst = exitTo(jump.second);
+        } else {
+            error("LINE NUMBER ERROR");
+        }
+    }
+    threadJumps();
+}
+
+static bool hasAssignment(const PostfixExp &exp) {
+    for (const PostfixOp &op : exp.getOps()) {
+        if (op.code == PF_ASSIGN || op.code == PF_ILLEGAL_ASSIGN) return true;
+    }
+    return false;
+}
+
+void RegisterCompiler::compileStatement(Statement *stmt) {
+    switch (stmt->getType()) {
+        case REM_STMT:
+            break;
+        case LET_STMT: {
+            auto *let = (LET *) stmt;
+            _copyLoads = hasAssignment(let->getExp());
+            compileExp(let->getExp(), variable(let->getSlot()));
+            break;
+        }
+        case PRINT_STMT: {
+            const PostfixExp &exp = ((PRINT *) stmt)->getExp();
+            _copyLoads = hasAssignment(exp);
+            compileExp(exp);
+            emit(REG_PRINT, 0, _operands.back().reg);
+            _operands.pop_back();
+            break;
+        }
+        case INPUT_STMT:
+            emit(REG_INPUT, variable(((INPUT *) stmt)->getSlot()));
+            break;
+        case END_STMT:
+            emit(REG_HALT, 0);
+            break;
+        case GOTO_STMT:
+            emitJump(REG_JUMP, ((GOTO *) stmt)->getLineNumber());
+            break;
+        case IF_STMT: {
+            auto *ifStmt = (IF *) stmt;
+            _copyLoads = hasAssignment(ifStmt->getLHS()) || hasAssignment(ifStmt->getRHS());
+            compileExp(ifStmt->getLHS());
+            compileExp(ifStmt->getRHS());
+            int rhs = _operands.back().reg;
+            _operands.pop_back();
+            int lhs = _operands.back().reg;
+            _operands.pop_back();
+            switch (ifStmt->getComparison()) {
+                case LESS_THAN: emitJump(REG_JUMP_LESS, ifStmt->getLineNumber(), lhs, rhs); break;
+                case GREATER_THAN: emitJump(REG_JUMP_GREATER, ifStmt->getLineNumber(), lhs, rhs); break;
+                case EQUAL_TO: emitJump(REG_JUMP_EQUAL, ifStmt->getLineNumber(), lhs, rhs); break;
+            }
+            break;
+        }
+    }
+}
+
+/**
+ * Implementation notes: compileExp
+ * <br>
+ * The postfix operations are run at compile time on a stack of operands,
+ * which are registers: a constant or a variable is pushed as its own
+ * register without any instruction, and an operator takes its operands
+ * from the stack and leaves its result in the temporary for its depth,
+ * or in dst for the last operator of a LET.
+ * <br>
+ * A variable is then read by the instruction using it rather than where
+ * the stack form loads it, which changes nothing but the point where an
+ * undefined one is reported.  That only matters before an instruction
+ * which can fail in another way, a division or an illegal assignment, so
+ * the variables still waiting on the stack are checked right before it.
+ * If the statement assigns a variable inside an expression, a variable
+ * may also change before it is used; every variable is then copied into
+ * its temporary where it is loaded, exactly as the stack form does.
+ */
+void RegisterCompiler::compileExp(const PostfixExp &exp, int dst) {
+    const std::vector<PostfixOp> &ops = exp.getOps();
+    bool wroteDst = false;
+    for (std::size_t i = 0; i < ops.size(); ++i) {
+        const PostfixOp &op = ops[i];
+        Operand rhs = {0, false};
+        RegOpCode code = REG_ADD;
+        switch (op.code) {
+            case PF_CONST:
+                _operands.push_back({constantOf(op.operand), false});
+                continue;
+            case PF_LOAD:
+                variable(op.operand);
+                if (_copyLoads) {
+                    int copy = temporary();
+                    emit(REG_MOVE, copy, op.operand);
+                    _operands.push_back({copy, false});
+                } else {
+                    _operands.push_back({op.operand, true});
+                }
+                continue;
+            case PF_ASSIGN:
+                emit(REG_MOVE, variable(op.operand), _operands.back().reg);
+                continue;
+            case PF_ILLEGAL_ASSIGN:
+                checkPending();
+                emit(REG_FAIL, 0, messageOf("Illegal variable in assignment"));
+                continue;
+            case PF_ADD: case PF_SUB: case PF_MUL: case PF_DIV:
+                rhs = _operands.back();
+                _operands.pop_back();
+                code = RegOpCode(REG_ADD + (op.code - PF_ADD));
+                break;
+            case PF_ADD_CONST: case PF_SUB_CONST: case PF_MUL_CONST: case PF_DIV_CONST:
+                rhs = {constantOf(op.operand), false};
+                code = RegOpCode(REG_ADD + (op.code - PF_ADD_CONST));
+                break;
+            case PF_ADD_VAR: case PF_SUB_VAR: case PF_MUL_VAR: case PF_DIV_VAR:
+                rhs = {variable(op.operand), true};
+                code = RegOpCode(REG_ADD + (op.code - PF_ADD_VAR));
+                break;
+        }
+
+        Operand lhs = _operands.back();
+        _operands.pop_back();
+        bool constantDivisor = op.code == PF_DIV_CONST && op.operand != 0;
+        if (code == REG_DIV && !constantDivisor) checkPending();
+        int result;
+        if (dst >= 0 && i + 1 == ops.size()) {
+            result = dst;
+            wroteDst = true;
+        } else {
+            result = temporary();
+        }
+        emit(code, result, lhs.reg, rhs.reg);
+        _operands.push_back({result, false});
+    }
+
+    if (dst >= 0) {
+        if (!wroteDst) emit(REG_MOVE, dst, _operands.back().reg);
+        _operands.pop_back();
+    }
+}
+
+void RegisterCompiler::checkPending() {
+    for (Operand &operand : _operands) {
+        if (operand.pending) {
+            emit(REG_CHECK, 0, operand.reg);
+            operand.pending = false;
+        }
+    }
+}
+
+/**
+ * Implementation notes: temporary
+ * <br>
+ * Returns the temporary for the top of the operand stack.  Temporaries
+ * are shared by all statements and numbered by stack depth, so a program
+ * needs as many as its deepest expression.
+ */
+int RegisterCompiler::temporary() {
+    std::size_t depth = _operands.size();
+    while (_temporaries.size() <= depth) _temporaries.push_back(_code.registerCount++);
+    return _temporaries[depth];
+}
+
+int RegisterCompiler::constantOf(int value) {
+    auto constant = _constants.find(value);
+    if (constant != _constants.end()) return constant->second;
+    int reg = _code.registerCount++;
+    _constants.emplace(value, reg);
+    _code.constants.emplace_back(reg, value);
+    return reg;
+}
+
+int RegisterCompiler::messageOf(const std::string &message) {
+    for (std::size_t i = 0; i < _code.messages.size(); ++i) {
+        if (_code.messages[i] == message) return int(i);
+    }
+    _code.messages.push_back(message);
+    return int(_code.messages.size()) - 1;
+}
+
+/**
+ * Implementation notes: threadJumps
+ * <br>
+ * The same as in the BytecodeCompiler: a jump landing on an unconditional
+ * jump goes straight to where that one leads.
+ */
+void RegisterCompiler::threadJumps() {
+    std::vector<RegInstruction> &code = _code.code;
+    for (RegInstruction &ins : code) {
+        if (ins.op < REG_JUMP || ins.op > REG_JUMP_EQUAL) continue;
+        int target = ins.dst;
+        for (std::size_t steps = 0; code[target].op == REG_JUMP && steps < code.size(); ++steps) {
+            target = code[target].dst;
+        }
+        ins.dst = target;
+    }
+}
+
+int RegisterCompiler::exitTo(int lineNumber) {
+    auto exit = _exits.find(lineNumber);
+    if (exit != _exits.end()) return exit->second;
+    int address = int(_code.code.size());
+    _exits.emplace(lineNumber, address);
+    emit(REG_EXIT, lineNumber);
+    return address;
+}
+
+/**
+ * Lists the variable among the ones the code uses, the first time it
+ * appears, and returns its register.
+ */
+int RegisterCompiler::variable(int slot) {
+    if (!_used[slot]) {
+        _used[slot] = true;
+        _code.variables.push_back(slot);
+    }
+    return slot;
+}
+
+void RegisterCompiler::emit(RegOpCode op, int dst, int a, int b) {
+    _code.code.push_back({op, dst, a, b});
+}
+
+void RegisterCompiler::emitJump(RegOpCode op, int lineNumber, int a, int b) {
+    _jumps.emplace_back(int(_code.code.size()), lineNumber);
+    emit(op, -1, a, b);
+}
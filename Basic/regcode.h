@@ -0,0 +1,154 @@
+/**
+ * @file regcode.h
+ *
+ * This interface defines the three-address instruction set of the
+ * register machine and a compiler that lowers a whole Program into it.
+ */
+
+#ifndef _regcode_h
+#define _regcode_h
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "postfix.h"
+#include "program.h"
+#include "statement.h"
+
+/**
+ * @enum RegOpCode
+ *
+ * The operations of the register machine.  Operands are registers unless
+ * stated otherwise, and every register read is checked for being defined,
+ * as reading a variable is.
+ */
+enum RegOpCode {
+    REG_MOVE,         // dst = a
+    REG_ADD,          // dst = a + b
+    REG_SUB,          // dst = a - b
+    REG_MUL,          // dst = a * b
+    REG_DIV,          // dst = a / b
+    REG_CHECK,        // report VARIABLE NOT DEFINED unless a is defined
+    REG_JUMP,         // jump to instruction dst
+    REG_JUMP_LESS,    // jump to instruction dst if a < b
+    REG_JUMP_GREATER, // jump to instruction dst if a > b
+    REG_JUMP_EQUAL,   // jump to instruction dst if a == b
+    REG_PRINT,        // print a
+    REG_INPUT,        // read a value into dst
+    REG_FAIL,         // report messages[a]
+    REG_EXIT,         // leave the code, which continues at line dst
+    REG_HALT
+};
+
+struct RegInstruction {
+    RegOpCode op;
+    int dst;
+    int a;
+    int b;
+};
+
+/**
+ * @class RegisterCode
+ *
+ * The compiled form of a whole program or of a loop.  The first registers
+ * are the variables, each numbered by its EvalState slot, of which only
+ * the ones listed in variables are used.  The others hold either a
+ * constant, listed with its value in constants, or a temporary of an
+ * expression; they are always defined.
+ */
+class RegisterCode {
+public:
+    std::vector<RegInstruction> code;
+    std::vector<std::string> messages;
+    std::vector<std::pair<int, int>> constants; // register, value
+    std::vector<int> variables;                 // the variables the code reads or writes
+    int variableCount = 0;
+    int registerCount = 0;
+};
+
+/**
+ * @class RegisterCompiler
+ *
+ * This class translates every statement of a Program in line order, the
+ * way the BytecodeCompiler does, except that an expression is compiled
+ * into three-address instructions working directly on registers.
+ * Variables and constants are used where they are, and the result of the
+ * last operation of a LET is written straight into the variable, so
+ * LET C = A * B + D takes two instructions.
+ * <br>
+ * A loop can also be compiled on its own, for Program::run to switch to
+ * once it is hot.  Control leaving it then stops the code by an EXIT to
+ * the line where the program goes on.
+ */
+class RegisterCompiler {
+public:
+    /**
+     * Compile
+     * @param program The Program to Compile
+     * @return the Register Code of the Whole Program
+     */
+    RegisterCode compile(Program &program);
+
+    /**
+     * Compile a Loop
+     * @param program The Program the Loop is in
+     * @param first The First Line of the Loop
+     * @param last The Last Line of the Loop
+     * @return the Register Code of the Lines from first to last
+     *
+     * The code starts at the first line.  A jump to a line outside of the
+     * loop, or running past the last line, leaves the code by an EXIT to
+     * that line; running past the end of the program halts.  Every target
+     * line must exist.
+     */
+    RegisterCode compileLoop(Program &program, int first, int last);
+
+private:
+    void reset();
+
+    void patchJumps(bool exitOutside);
+
+    void compileStatement(Statement *stmt);
+
+    void compileExp(const PostfixExp &exp, int dst = -1);
+
+    void checkPending();
+
+    int temporary();
+
+    int constantOf(int value);
+
+    void threadJumps();
+
+    int messageOf(const std::string &message);
+
+    void emit(RegOpCode op, int dst, int a = 0, int b = 0);
+
+    void emitJump(RegOpCode op, int lineNumber, int a = 0, int b = 0);
+
+    int exitTo(int lineNumber);
+
+    int variable(int slot);
+
+    /**
+     * An operand of the expression being compiled, and whether it is a
+     * variable which may be undefined and has not been checked yet.
+     */
+    struct Operand {
+        int reg;
+        bool pending;
+    };
+
+    RegisterCode _code;
+    std::map<int, int> _constants;
+    std::map<int, int> _lineAddress;
+    std::map<int, int> _exits;
+    std::vector<std::pair<int, int>> _jumps;
+    std::vector<Operand> _operands;
+    std::vector<int> _temporaries;
+    std::vector<char> _used;           // whether each variable is in _code.variables
+    bool _copyLoads = false;
+};
+
+#endif
@@ -0,0 +1,170 @@
+/**
+ * @file regvm.cpp
+ *
+ * This file implements the RegisterMachine class.
+ */
+
+#include <cstddef>
+#include "regvm.h"
+#include "output.h"
+#include "statement.h"
+
+#include "../StanfordCPPLib/error.h"
+
+int RegisterMachine::run(const RegisterCode &code, EvalState &state) {
+    load(code, state);
+    return finish(code, nullptr, state);
+}
+
+int RegisterMachine::runNative(const RegisterCode &code, EvalState &state) {
+    load(code, state);
+    NativeCode native(code, _defined);
+    return finish(code, &native, state);
+}
+
+int RegisterMachine::run(const RegisterCode &code, const NativeCode &native, EvalState &state) {
+    load(code, state);
+    return finish(code, &native, state);
+}
+
+std::unique_ptr<NativeCode> RegisterMachine::translate(const RegisterCode &code, EvalState &state) {
+    load(code, state);
+    return std::unique_ptr<NativeCode>(new NativeCode(code, _defined));
+}
+
+/**
+ * Implementation notes: finish
+ * <br>
+ * Runs the loaded code, natively if it has been translated for variables
+ * which are still defined.  Native code reports an error by its status,
+ * after which the variables are written back before the error is raised
+ * here.
+ */
+int RegisterMachine::finish(const RegisterCode &code, const NativeCode *native, EvalState &state) {
+    if (native == nullptr || !native->isReady() || !native->isValidFor(_defined)) {
+        int next;
+        try {
+            next = execute(code);
+        } catch (...) {
+            writeBack(code, state);
+            throw;
+        }
+        writeBack(code, state);
+        return next;
+    }
+    int status = native->run(_registers.data(), _defined.data());
+    writeBack(code, state);
+    if (status < 0) return -1 - status;
+    if (status != NATIVE_HALT) error(native->getMessage(status));
+    return -1;
+}
+
+/**
+ * Implementation notes: load
+ * <br>
+ * Only the variables the code uses are copied in, so entering a loop
+ * costs nothing for the other variables of the program.  The registers
+ * of those are left as they are, since the code never touches them.
+ */
+void RegisterMachine::load(const RegisterCode &code, EvalState &state) {
+    if (_registers.size() < std::size_t(code.registerCount)) {
+        _registers.resize(code.registerCount);
+        _defined.resize(code.registerCount);
+    }
+    for (int slot : code.variables) {
+        _defined[slot] = state.isDefined(slot);
+        if (_defined[slot]) _registers[slot] = state.getValue(slot);
+    }
+    for (int reg = code.variableCount; reg < code.registerCount; ++reg) _defined[reg] = true;
+    for (auto &constant : code.constants) {
+        _registers[constant.first] = constant.second;
+    }
+}
+
+/**
+ * The main loop keeps the program counter and the register file in local
+ * variables.  A register which is written becomes defined; only variables
+ * can be undefined in the first place.
+ */
+int RegisterMachine::execute(const RegisterCode &code) {
+    int *r = _registers.data();
+    char *defined = _defined.data();
+    const RegInstruction *start = code.code.data();
+    const RegInstruction *pc = start;
+
+    while (true) {
+        const RegInstruction &ins = *pc++;
+        switch (ins.op) {
+            case REG_MOVE:
+                if (!defined[ins.a]) error("VARIABLE NOT DEFINED");
+                r[ins.dst] = r[ins.a];
+                defined[ins.dst] = true;
+                break;
+            case REG_ADD:
+                if (!(defined[ins.a] & defined[ins.b])) error("VARIABLE NOT DEFINED");
+                r[ins.dst] = r[ins.a] + r[ins.b];
+                defined[ins.dst] = true;
+                break;
+            case REG_SUB:
+                if (!(defined[ins.a] & defined[ins.b])) error("VARIABLE NOT DEFINED");
+                r[ins.dst] = r[ins.a] - r[ins.b];
+                defined[ins.dst] = true;
+                break;
+            case REG_MUL:
+                if (!(defined[ins.a] & defined[ins.b])) error("VARIABLE NOT DEFINED");
+                r[ins.dst] = r[ins.a] * r[ins.b];
+                defined[ins.dst] = true;
+                break;
+            case REG_DIV:
+                if (!(defined[ins.a] & defined[ins.b])) error("VARIABLE NOT DEFINED");
+                if (r[ins.b] == 0) error("DIVIDE BY ZERO");
+                r[ins.dst] = r[ins.a] / r[ins.b];
+                defined[ins.dst] = true;
+                break;
+            case REG_CHECK:
+                if (!defined[ins.a]) error("VARIABLE NOT DEFINED");
+                break;
+            case REG_JUMP:
+                pc = start + ins.dst;
+                break;
+            case REG_JUMP_LESS:
+                if (!(defined[ins.a] & defined[ins.b])) error("VARIABLE NOT DEFINED");
+                if (r[ins.a] < r[ins.b]) pc = start + ins.dst;
+                break;
+            case REG_JUMP_GREATER:
+                if (!(defined[ins.a] & defined[ins.b])) error("VARIABLE NOT DEFINED");
+                if (r[ins.a] > r[ins.b]) pc = start + ins.dst;
+                break;
+            case REG_JUMP_EQUAL:
+                if (!(defined[ins.a] & defined[ins.b])) error("VARIABLE NOT DEFINED");
+                if (r[ins.a] == r[ins.b]) pc = start + ins.dst;
+                break;
+            case REG_PRINT:
+                if (!defined[ins.a]) error("VARIABLE NOT DEFINED");
+                output().writeNumber(r[ins.a]);
+                output().endLine();
+                break;
+            case REG_INPUT:
+                r[ins.dst] = readInputValue();
+                defined[ins.dst] = true;
+                break;
+            case REG_FAIL:
+                error(code.messages[ins.a]);
+                break;
+            case REG_EXIT:
+                return ins.dst;
+            case REG_HALT:
+                return -1;
+        }
+    }
+}
+
+/**
+ * Variables never become undefined while a program runs, so only the
+ * defined ones of the code need to be copied.
+ */
+void RegisterMachine::writeBack(const RegisterCode &code, EvalState &state) const {
+    for (int slot : code.variables) {
+        if (_defined[slot]) state.setValue(slot, _registers[slot]);
+    }
+}
@@ -0,0 +1,82 @@
+/**
+ * @file regvm.h
+ *
+ * This interface exports the register machine that executes the
+ * RegisterCode produced by the RegisterCompiler.
+ */
+
+#ifndef _regvm_h
+#define _regvm_h
+
+#include <memory>
+#include <vector>
+#include "evalstate.h"
+#include "jit.h"
+#include "regcode.h"
+
+/**
+ * @class RegisterMachine
+ *
+ * The machine works on a register file of its own: the variables the code
+ * uses are copied into it from the EvalState when the code starts, and copied
+ * back when it stops, by HALT, EXIT or an error, so that direct mode and
+ * Program::run see the same variables as after a tree-walking run.
+ */
+class RegisterMachine {
+public:
+    /**
+     * Run
+     * @param code The Compiled Program
+     * @param state Evaluation State to Store the Value of Identifiers
+     * @return the Line an EXIT Continues at, or -1 after HALT
+     *
+     * Executes the code from its first instruction until HALT, EXIT or an
+     * error.  The output is identical to the one of Program::run.
+     */
+    int run(const RegisterCode &code, EvalState &state);
+
+    /**
+     * Run Natively
+     * @param code The Compiled Program
+     * @param state Evaluation State to Store the Value of Identifiers
+     * @return the Line an EXIT Continues at, or -1 after HALT
+     *
+     * The same as run(), except that the code is first translated into
+     * machine code by NativeCode, if it is supported.
+     */
+    int runNative(const RegisterCode &code, EvalState &state);
+
+    /**
+     * Run Natively
+     * @param code The Compiled Program
+     * @param native The Code as Translated by translate()
+     * @param state Evaluation State to Store the Value of Identifiers
+     * @return the Line an EXIT Continues at, or -1 after HALT
+     *
+     * The same as runNative(), for code which is run more than once.
+     */
+    int run(const RegisterCode &code, const NativeCode &native, EvalState &state);
+
+    /**
+     * Translate
+     * @param code The Compiled Program
+     * @param state Evaluation State to Store the Value of Identifiers
+     * @return the Native Code, for as long as no Variable Defined in state
+     *         Becomes Undefined
+     */
+    std::unique_ptr<NativeCode> translate(const RegisterCode &code, EvalState &state);
+
+private:
+    void load(const RegisterCode &code, EvalState &state);
+
+    int finish(const RegisterCode &code, const NativeCode *native, EvalState &state);
+
+    int execute(const RegisterCode &code);
+
+    void writeBack(const RegisterCode &code, EvalState &state) const;
+
+    std::vector<int> _registers;
+    std::vector<char> _defined;
+};
+
+#endif
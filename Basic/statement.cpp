@@ -7,9 +7,18 @@
  * BASIC statements.
  */
 
+#include <cctype>
+#include <cstddef>
 #include <string>
 #include "statement.h"
+#include "input.h"
+#include "arena.h"
+#include "keyword.h"
+#include "lexer.h"
+#include "optimizer.h"
+#include "output.h"
 #include "parser.h"
+#include "stats.h"
 
 /** Implementation of the Statement class */
 
@@ -24,6 +33,19 @@ std::ostream &operator<<(ostream &os, const Statement &stmt) {
 
 Statement::Statement(string line) : _line(std::move(line)) {}
 
+void Statement::compile() {
+    if (_compiled) return;
+    build();
+    _compiled = true;
+    ++statistics().compiledLines;
+}
+
+void Statement::build() {}
+
+const std::string &Statement::getSource() const {
+    return _line;
+}
+
 /** REM */
 REM::REM() = default;
 
@@ -35,94 +57,146 @@ void REM::execute(Program &program, EvalState &state) {
     program.nextLine();
 }
 
+StatementType REM::getType() {
+    return REM_STMT;
+}
+
 /** LET */
 LET::LET() = default;
 
-LET::LET(const std::string &line) : Statement(line) {}
+static bool isNotAssign(const char c) {
+    return c != '=';
+}
+
+LET::LET(const std::string &line, Lexer &lexer, bool inProgram) : Statement(line) {
+    // Cannot just use parseExp for the whole line because it cannot tell
+    // "LET x" is a SYNTAX ERROR.
+    _identifier = std::string(lexer.nextToken().text);
+    if (!identifierCheck(_identifier)) error("SYNTAX ERROR");
+    Token assign = lexer.nextToken();
+    if (assign.kind != TOKEN_OPERATOR || assign.text != "=") error("SYNTAX ERROR");
+    _slot = EvalState::getSlot(_identifier);
+    if (inProgram) {
+        lexer.allowOnly(isNotAssign, lexer.position());
+        _expStart = lexer.position();
+        checkExp(lexer);
+        _compiled = false;
+        return;
+    }
+    ExpArena arena;
+    _exp = PostfixExp(foldConstants(parseExp(lexer, arena), arena));
+}
 
 LET::~LET() = default;
 
+void LET::build() {
+    Lexer lexer(std::string_view(_line).substr(_expStart));
+    ExpArena arena;
+    _exp = PostfixExp(foldConstants(parseExp(lexer, arena), arena));
+}
+
 void LET::execute(Program &program, EvalState &state) {
-    TokenScanner scanner;
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    scanner.setInput(_line);
-    scanner.nextToken();
-
-    // Cannot just use calculate(scanner, state) because it cannot tell "LET x"
-    // is a SYNTAX ERROR.
-    std::string identifier = scanner.nextToken();
-    if (!identifierCheck(identifier)) error("SYNTAX ERROR");
-    if (scanner.nextToken() == "=") {
-        int value = calculate(scanner, state);
-        state.setValue(identifier, value);
-    } else {
-        error("SYNTAX ERROR");
-    }
+    compile();
+    state.setValue(_slot, _exp.eval(state));
     program.nextLine();
 }
 
+StatementType LET::getType() {
+    return LET_STMT;
+}
+
+std::string LET::getIdentifier() const {
+    return _identifier;
+}
+
+int LET::getSlot() const {
+    return _slot;
+}
+
+const PostfixExp &LET::getExp() {
+    compile();
+    return _exp;
+}
+
 /** PRINT */
 PRINT::PRINT() = default;
 
-PRINT::PRINT(const std::string &line) : Statement(line) {}
+/**
+ * A program line is checked character by character from offset 6 on,
+ * right after "PRINT ", so spaces inside the expression are rejected.
+ */
+PRINT::PRINT(const std::string &line, Lexer &lexer, bool inProgram) : Statement(line) {
+    if (inProgram) {
+        lexer.allowOnly(isValidChar, 6);
+        _expStart = lexer.position();
+        checkExp(lexer);
+        _compiled = false;
+        return;
+    }
+    ExpArena arena;
+    _exp = PostfixExp(foldConstants(parseExp(lexer, arena), arena));
+}
 
 PRINT::~PRINT() = default;
 
+void PRINT::build() {
+    Lexer lexer(std::string_view(_line).substr(_expStart));
+    ExpArena arena;
+    _exp = PostfixExp(foldConstants(parseExp(lexer, arena), arena));
+}
+
 void PRINT::execute(Program &program, EvalState &state) {
-    TokenScanner scanner;
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    scanner.setInput(_line);
-    scanner.nextToken();
-    std::cout << calculate(scanner, state) << std::endl;
+    compile();
+    output().writeNumber(_exp.eval(state));
+    output().endLine();
     program.nextLine();
 }
 
+StatementType PRINT::getType() {
+    return PRINT_STMT;
+}
+
+const PostfixExp &PRINT::getExp() {
+    compile();
+    return _exp;
+}
+
 /** INPUT */
 INPUT::INPUT() = default;
 
-INPUT::INPUT(const std::string &line) : Statement(line) {}
+INPUT::INPUT(const std::string &line, Lexer &lexer) : Statement(line) {
+
+    _identifier = std::string(lexer.nextToken().text);
+    if (!identifierCheck(_identifier)) error("SYNTAX ERROR");
+    if (lexer.hasMoreTokens()) error("SYNTAX ERROR");
+    _slot = EvalState::getSlot(_identifier);
+}
 
 INPUT::~INPUT() = default;
 
 void INPUT::execute(Program &program, EvalState &state) {
-    TokenScanner scanner;
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    scanner.setInput(_line);
-    scanner.nextToken();
+    state.setValue(_slot, readInputValue());
+    program.nextLine();
+}
 
-    std::string identifier = scanner.nextToken();
-    if (!identifierCheck(identifier)) error("SYNTAX ERROR");
-    if (scanner.hasMoreTokens()) error("SYNTAX ERROR");
-    std::cout << " ? ";
+StatementType INPUT::getType() {
+    return INPUT_STMT;
+}
 
-    int value;
-    while (true) {
-        std::cin >> value;
-        if (std::cin.fail()) {
-            std::cin.clear();
-            getLine(std::string());
-            std::cout << "INVALID NUMBER" << std::endl << " ? ";
-            continue;
-        }
-        while (std::cin.peek() == ' ') std::cin.get();
-        if (std::cin.get() != '\n') {
-            getLine(std::string());
-            std::cout << "INVALID NUMBER" << std::endl << " ? ";
-            continue;
-        }
-        break;
-    }
-    state.setValue(identifier, value);
-    program.nextLine();
+std::string INPUT::getIdentifier() const {
+    return _identifier;
+}
+
+int INPUT::getSlot() const {
+    return _slot;
 }
 
 /** END */
 END::END() = default;
 
-END::END(const string &line) : Statement(line) {}
+END::END(const string &line, Lexer &lexer) : Statement(line) {
+    if (lexer.hasMoreTokens()) error("SYNTAX ERROR");
+}
 
 END::~END() = default;
 
@@ -130,88 +204,114 @@ void END::execute(Program &program, EvalState &state) {
     program.end();
 }
 
+StatementType END::getType() {
+    return END_STMT;
+}
+
 /** GOTO */
 GOTO::GOTO() = default;
 
-GOTO::GOTO(const std::string &line) : Statement(line) {}
+GOTO::GOTO(const std::string &line, Lexer &lexer) : Statement(line) {
+
+    Token target = lexer.nextToken();
+    if (target.kind != TOKEN_NUMBER) error("SYNTAX ERROR");
+    _lineNumber = target.value;
+    if (lexer.hasMoreTokens()) error("SYNTAX ERROR");
+}
 
 GOTO::~GOTO() = default;
 
 void GOTO::execute(Program &program, EvalState &state) {
-    TokenScanner scanner;
-    scanner.ignoreWhitespace();
-    scanner.scanNumbers();
-    scanner.setInput(_line);
-    scanner.nextToken();
+    program.goTo(_lineNumber);
+}
 
-    std::string token = scanner.nextToken();
-    int lineNumber = stringToInt(token);
-    if (scanner.hasMoreTokens()) error("SYNTAX ERROR");
-    program.goTo(lineNumber);
+StatementType GOTO::getType() {
+    return GOTO_STMT;
+}
+
+int GOTO::getLineNumber() const {
+    return _lineNumber;
 }
 
 /** IF */
 IF::IF() = default;
 
-IF::IF(const std::string &line) : Statement(line) {}
+static bool isConditionChar(const char c) {
+    return isValidChar(c) || c == '<' || c == '>' || std::isspace((unsigned char) c);
+}
+
+/**
+ * Both sides are checked with checkE, and later parsed with readE, at the
+ * precedence of "=", so that the parser stops in front of the comparative
+ * operator and in front of THEN instead of treating "=" as an assignment.
+ * Apart from the comparative operators and whitespace, only valid
+ * characters may appear in the line.
+ */
+IF::IF(const std::string &line, Lexer &lexer) : Statement(line) {
+    lexer.allowOnly(isConditionChar);
+    _expStart = lexer.position();
+    checkE(lexer, 1);
+    Token op = lexer.nextToken();
+    if (op.kind != TOKEN_OPERATOR) error("SYNTAX ERROR");
+    if (op.text == "<") _comparison = LESS_THAN;
+    else if (op.text == ">") _comparison = GREATER_THAN;
+    else if (op.text == "=") _comparison = EQUAL_TO;
+    else error("SYNTAX ERROR");
+    checkE(lexer, 1);
+    Token then = lexer.nextToken();
+    if (then.kind != TOKEN_WORD || toKeyword(then.text) != KEYWORD_THEN) error("SYNTAX ERROR");
+    Token target = lexer.nextToken();
+    if (target.kind != TOKEN_NUMBER) error("SYNTAX ERROR");
+    _lineNumber = target.value;
+    if (lexer.hasMoreTokens()) error("SYNTAX ERROR");
+    _compiled = false;
+}
 
 IF::~IF() = default;
 
+/**
+ * The source has been checked, so the operator between the sides is only
+ * skipped.
+ */
+void IF::build() {
+    Lexer lexer(std::string_view(_line).substr(_expStart));
+    ExpArena arena;
+    _lhs = PostfixExp(foldConstants(readE(lexer, arena, 1), arena));
+    lexer.nextToken();
+    _rhs = PostfixExp(foldConstants(readE(lexer, arena, 1), arena));
+}
+
 void IF::execute(Program &program, EvalState &state) {
-    // Find '=', '<', or '>'
-    std::string tempLine = _line;
-    tempLine = tempLine.substr(3);
-    int op = 0;
-    while (tempLine[op] != '=' && tempLine[op] != '<' && tempLine[op] != '>') {
-        ++op;
-    }
-    std::string lhsString = tempLine.substr(0, op);
-    TokenScanner lhsScanner;
-    lhsScanner.ignoreWhitespace();
-    lhsScanner.scanNumbers();
-    lhsScanner.setInput(lhsString);
-    int lhs = calculate(lhsScanner, state);
-
-    // Calculate rhs
-    int end = op + 1;
-    while (tempLine[end] == ' ') ++end;
-    while (end < tempLine.length() && tempLine[end] != 'T'
-        && tempLine[end] != '=' && tempLine[end] != '<' && tempLine[end] != '>') ++end;
-    if (end == tempLine.length() || tempLine[end] == '='
-     || tempLine[end] == '<' || tempLine[end] == '>') error("SYNTAX ERROR");
-
-    --end;
-
-    std::string rhsString = tempLine.substr(op + 1, end - op - 1);
-    TokenScanner rhsScanner;
-    rhsScanner.ignoreWhitespace();
-    rhsScanner.scanNumbers();
-    rhsScanner.setInput(rhsString);
-    int rhs = calculate(rhsScanner, state);
-
-    // Check
-    if (check(tempLine[op], lhs, rhs)) {
-        tempLine = tempLine.substr(end + 1);
-        TokenScanner scanner;
-        scanner.ignoreWhitespace();
-        scanner.scanNumbers();
-        scanner.setInput(tempLine);
-        if (scanner.nextToken() == "THEN") {
-            std::string token = scanner.nextToken();
-            int lineNumber = stringToInt(token);
-            if (scanner.hasMoreTokens()) error("SYNTAX ERROR");
-            program.goTo(lineNumber);
-        } else {
-            error("SYNTAX ERROR");
-        }
+    compile();
+    int lhs = _lhs.eval(state);
+    int rhs = _rhs.eval(state);
+    if (check(_comparison, lhs, rhs)) {
+        program.goTo(_lineNumber);
     } else {
         program.nextLine();
     }
 }
 
-int calculate(TokenScanner &scanner, EvalState &state) {
-    Expression *exp = parseExp(scanner);
-    return exp->eval(state);
+StatementType IF::getType() {
+    return IF_STMT;
+}
+
+const PostfixExp &IF::getLHS() {
+    compile();
+    return _lhs;
+}
+
+const PostfixExp &IF::getRHS() {
+    compile();
+    return _rhs;
+}
+
+Comparison IF::getComparison() const {
+    return _comparison;
+}
+
+int IF::getLineNumber() const {
+    return _lineNumber;
 }
 
 bool isDigit(const char c) {
@@ -235,21 +335,16 @@ bool isValidChar(const char c) {
     else return false;
 }
 
-bool identifierCheck(const std::string &identifier) {
+bool identifierCheck(std::string_view identifier) {
     if (identifier.empty()) return false;
     if (!isLetter(identifier[0])) return false;
-    for (int i = 1; i < identifier.length(); ++i) {
+    for (std::size_t i = 1; i < identifier.length(); ++i) {
         if (!isLetterOrDigit(identifier[i])) return false;
     }
-    if (identifier == "REM" || identifier == "LET" || identifier == "PRINT"
-     || identifier == "END" || identifier == "RUN" || identifier == "INPUT"
-     || identifier == "GOTO" || identifier == "IF" || identifier == "THEN"
-     || identifier == "QUIT" || identifier == "LIST" || identifier == "CLEAR"
-     || identifier == "HELP") return false;
-    return true;
+    return toKeyword(identifier) == NOT_KEYWORD;
 }
 
-bool numberCheck(const std::string &identifier) {
+bool numberCheck(std::string_view identifier) {
     if (identifier.empty()) return false;
     for (char i : identifier) {
         if (!isDigit(i)) return false;
@@ -257,11 +352,12 @@ bool numberCheck(const std::string &identifier) {
     return true;
 }
 
-bool check(const char op, const int lhs, const int rhs) {
-    if (op == '=') return lhs == rhs;
-    if (op == '<') return lhs < rhs;
-    if (op == '>') return lhs > rhs;
-    error("SYNTAX ERROR");
+bool check(const Comparison comparison, const int lhs, const int rhs) {
+    switch (comparison) {
+        case LESS_THAN: return lhs < rhs;
+        case GREATER_THAN: return lhs > rhs;
+        case EQUAL_TO: return lhs == rhs;
+    }
     return false;
 }
 
@@ -279,3 +375,25 @@ int stringToInt(std::string s) {
     if (!isPositive) number = -number;
     return number;
 }
+
+/**
+ * The reader flushes the output before it waits for input, so the prompt
+ * is visible whenever the user is asked for a value.  If the input ends
+ * before a valid value is read, the program stops with INVALID NUMBER
+ * instead of asking forever.
+ */
+int readInputValue() {
+    OutputBuffer &out = output();
+    InputReader &reader = inputReader();
+    out.write(" ? ");
+
+    int value;
+    while (!reader.readInteger(value)) {
+        if (reader.atEnd()) error("INVALID NUMBER");
+        reader.skipLine();
+        out.write("INVALID NUMBER");
+        out.endLine();
+        out.write(" ? ");
+    }
+    return value;
+}
@@ -12,22 +12,12 @@
 #ifndef _statement_h
 #define _statement_h
 
+#include <cstddef>
+#include <string_view>
 #include "evalstate.h"
-#include "exp.h"
+#include "lexer.h"
+#include "postfix.h"
 #include "program.h"
-#include "../StanfordCPPLib/tokenscanner.h"
-#include "../StanfordCPPLib/simpio.h"
-
-/**
- * @param scanner The Token Scanner
- * @param state Evaluation State to Store the Value of identifiers
- * @return The Answer of a valid statement
- *
- * This function parses an calculating expression (including identifiers)
- * and return the answer.  When there is some error it will throw relevant
- * error and go back.
- */
-int calculate(TokenScanner &scanner, EvalState &state);
 
 bool isDigit(char c);
 
@@ -37,23 +27,53 @@ bool isLetterOrDigit(char c);
 
 bool isValidChar(char c);
 
-bool identifierCheck(const std::string &identifier);
+bool identifierCheck(std::string_view identifier);
+
+bool numberCheck(std::string_view identifier);
 
-bool numberCheck(const std::string &identifier);
+/**
+ * @enum Comparison
+ *
+ * The comparative operators of IF.
+ */
+enum Comparison {
+    LESS_THAN, GREATER_THAN, EQUAL_TO
+};
 
 /**
  *
- * @param op Comparative Operator
+ * @param comparison Comparative Operator
  * @param lhs
  * @param rhs
  * @return the Boolean of the Comparing Statement
  */
-bool check(char op, int lhs, int rhs);
+bool check(Comparison comparison, int lhs, int rhs);
 
 int stringToInt(std::string s);
 
+/**
+ * Read a Value for INPUT
+ * @return The Integer Entered by the User
+ *
+ * This function prompts the user and reads an integer from a single line
+ * of inputReader().  If the line is not a valid integer, it reports
+ * INVALID NUMBER and asks again until a valid one is entered.
+ */
+int readInputValue();
+
 class Program;
 
+/**
+ * @enum StatementType
+ *
+ * This enumerated type is used to differentiate the statement types,
+ * so that clients such as the bytecode compiler can inspect a statement
+ * the same way they inspect an Expression.
+ */
+enum StatementType {
+    REM_STMT, LET_STMT, PRINT_STMT, INPUT_STMT, END_STMT, GOTO_STMT, IF_STMT
+};
+
 /**
  * @class Statement
  *
@@ -97,10 +117,34 @@ public:
      */
     virtual void execute(Program &program, EvalState &state) = 0;
 
+    virtual StatementType getType() = 0;
+
+    /**
+     * Compile
+     *
+     * A program line is only checked when it is entered.  The first call
+     * builds its executable form from the source, and later calls do
+     * nothing, so it costs nothing for a line that never runs.  Every
+     * accessor of the executable form calls it.
+     */
+    void compile();
+
+    /**
+     * @return the Text of the Statement, without the line number
+     */
+    const std::string &getSource() const;
+
     friend std::ostream &operator<<(std::ostream &os, const Statement &stmt);
 
 protected:
+    /**
+     * Builds the executable form of a statement constructed as not compiled
+     * yet, from the source that was checked by the constructor.
+     */
+    virtual void build();
+
     std::string _line;
+    bool _compiled = true;
 };
 
 class REM : public Statement {
@@ -112,72 +156,170 @@ public:
     ~REM() override;
 
     void execute(Program &program, EvalState &state) override;
+
+    StatementType getType() override;
 };
 
+/**
+ * @class LET
+ *
+ * The identifier and the expression are parsed once when the statement is
+ * constructed.  The tree of the expression is folded and compiled into a
+ * PostfixExp and then discarded, so that executing the statement runs a
+ * flat array of operations.  In a program line, the expression is only
+ * checked at first, and parsed by compile().
+ *
+ * The statements that take a Lexer continue scanning the line from where
+ * the caller has read the keyword, and check the syntax of the line while
+ * they build it: every malformed line is reported as SYNTAX ERROR by the
+ * constructor.
+ */
 class LET : public Statement {
 public:
     LET();
 
-    explicit LET(const std::string &line);
+    /**
+     * @param line
+     * @param lexer The Lexer of the Line, past the Keyword
+     * @param inProgram Whether the Line is a Program Line, where the
+     * expression may not contain another "="
+     */
+    LET(const std::string &line, Lexer &lexer, bool inProgram = false);
 
     ~LET() override;
 
     void execute(Program &program, EvalState &state) override;
+
+    StatementType getType() override;
+
+    std::string getIdentifier() const;
+
+    int getSlot() const;
+
+    const PostfixExp &getExp();
+
+private:
+    void build() override;
+
+    std::string _identifier;
+    int _slot = -1;
+    std::size_t _expStart = 0;         // where the expression begins in the source
+    PostfixExp _exp;
 };
 
 class PRINT : public Statement {
 public:
     PRINT();
 
-    explicit PRINT(const std::string &line);
+    /**
+     * @param line
+     * @param lexer The Lexer of the Line, past the Keyword
+     * @param inProgram Whether the Line is a Program Line, where only
+     * valid characters and no spaces may follow "PRINT "
+     */
+    PRINT(const std::string &line, Lexer &lexer, bool inProgram = false);
 
     ~PRINT() override;
 
     void execute(Program &program, EvalState &state) override;
+
+    StatementType getType() override;
+
+    const PostfixExp &getExp();
+
+private:
+    void build() override;
+
+    std::size_t _expStart = 0;         // where the expression begins in the source
+    PostfixExp _exp;
 };
 
 class INPUT : public Statement {
 public:
     INPUT();
 
-    explicit INPUT(const std::string &line);
+    INPUT(const std::string &line, Lexer &lexer);
 
     ~INPUT() override;
 
     void execute(Program &program, EvalState &state) override;
+
+    StatementType getType() override;
+
+    std::string getIdentifier() const;
+
+    int getSlot() const;
+
+private:
+    std::string _identifier;
+    int _slot = -1;
 };
 
 class END : public Statement {
 public:
     END();
 
-    explicit END(const std::string &line);
+    END(const std::string &line, Lexer &lexer);
 
     ~END() override;
 
     void execute(Program &program, EvalState &state) override;
+
+    StatementType getType() override;
 };
 
 class GOTO : public Statement {
 public:
     GOTO();
 
-    explicit GOTO(const std::string &line);
+    GOTO(const std::string &line, Lexer &lexer);
 
     ~GOTO() override;
 
     void execute(Program &program, EvalState &state) override;
+
+    StatementType getType() override;
+
+    int getLineNumber() const;
+
+private:
+    int _lineNumber = -1;
 };
 
+/**
+ * @class IF
+ *
+ * The comparative operator and the target line number are parsed when the
+ * statement is constructed.  Both sides of the comparison are only checked
+ * then, and parsed by compile().
+ */
 class IF : public Statement {
 public:
     IF();
 
-    explicit IF(const std::string &line);
+    IF(const std::string &line, Lexer &lexer);
 
     ~IF() override;
 
     void execute(Program &program, EvalState &state) override;
+
+    StatementType getType() override;
+
+    const PostfixExp &getLHS();
+
+    const PostfixExp &getRHS();
+
+    Comparison getComparison() const;
+
+    int getLineNumber() const;
+
+private:
+    void build() override;
+
+    std::size_t _expStart = 0;         // where the left side begins in the source
+    PostfixExp _lhs, _rhs;
+    Comparison _comparison = EQUAL_TO;
+    int _lineNumber = -1;
 };
 
 #endif
@@ -0,0 +1,39 @@
+/**
+ * @file stats.cpp
+ *
+ * This file implements the Statistics class.
+ */
+
+#include "stats.h"
+
+/**
+ * Implementation notes: printCounter
+ * <br>
+ * Prints a line of the form "NAME: value".
+ */
+static void printCounter(OutputBuffer &out, const char *name, long value) {
+    out.write(name);
+    out.write(": ");
+    out.writeNumber(value);
+    out.endLine();
+}
+
+void Statistics::print(OutputBuffer &out) const {
+    printCounter(out, "FOLDED NODES", foldedNodes);
+    printCounter(out, "SIMPLIFIED NODES", simplifiedNodes);
+    printCounter(out, "FUSED OPERANDS", fusedOperands);
+    printCounter(out, "FUSED INCREMENTS", fusedIncrements);
+    printCounter(out, "FUSED VARIABLE ADDS", fusedVariableAdds);
+    printCounter(out, "FUSED BRANCHES", fusedBranches);
+    printCounter(out, "THREADED JUMPS", threadedJumps);
+    printCounter(out, "HOT LOOPS", hotLoops);
+    printCounter(out, "TIER TRANSFERS", tierTransfers);
+    printCounter(out, "RELINKED LINES", relinkedLines);
+    printCounter(out, "INVALIDATED LOOPS", invalidatedLoops);
+    printCounter(out, "COMPILED LINES", compiledLines);
+}
+
+Statistics &statistics() {
+    static Statistics stats;
+    return stats;
+}
@@ -0,0 +1,70 @@
+/**
+ * @file stats.h
+ *
+ * This interface exports the counters that describe what the optimizing
+ * parts of the interpreter have done, and which are printed by the STATS
+ * command.
+ */
+
+#ifndef _stats_h
+#define _stats_h
+
+#include "output.h"
+
+/**
+ * @class Statistics
+ *
+ * Every counter accumulates from the start of the interpreter.
+ */
+class Statistics {
+public:
+    /** CompoundExp nodes whose operands were constants, folded into one */
+    long foldedNodes = 0;
+
+    /** CompoundExp nodes removed by an identity such as x * 1 or x + 0 */
+    long simplifiedNodes = 0;
+
+    /** Arithmetic instructions that take their right operand directly */
+    long fusedOperands = 0;
+
+    /** LET statements compiled into adding a constant to a variable */
+    long fusedIncrements = 0;
+
+    /** LET statements compiled into adding a variable to a variable */
+    long fusedVariableAdds = 0;
+
+    /** IF statements compiled into a single compare-and-jump */
+    long fusedBranches = 0;
+
+    /** Jumps redirected past an unconditional jump they landed on */
+    long threadedJumps = 0;
+
+    /** Loops compiled by Program::run once they became hot */
+    long hotLoops = 0;
+
+    /** Switches from the line table of Program::run into a compiled loop */
+    long tierTransfers = 0;
+
+    /** Lines whose handler was updated after an edit instead of rebuilt */
+    long relinkedLines = 0;
+
+    /** Compiled loops dropped because one of their lines was edited */
+    long invalidatedLoops = 0;
+
+    /** Program lines compiled into their executable form, when they were first needed */
+    long compiledLines = 0;
+
+    /**
+     * @param out
+     *
+     * Prints every counter on a line of its own.
+     */
+    void print(OutputBuffer &out) const;
+};
+
+/**
+ * @return the Counters of the Interpreter
+ */
+Statistics &statistics();
+
+#endif
@@ -0,0 +1,150 @@
+/**
+ * @file vm.cpp
+ *
+ * This file implements the VirtualMachine class.
+ */
+
+#include "vm.h"
+#include "output.h"
+
+#include "../StanfordCPPLib/error.h"
+
+/**
+ * The main loop keeps the program counter and the stack pointer in local
+ * variables; sp always points at the first free element of the stack.
+ */
+void VirtualMachine::run(const Bytecode &bytecode, EvalState &state) {
+    _stack.assign(bytecode.maxStackDepth + 1, 0);
+    const Instruction *code = bytecode.code.data();
+    const Instruction *pc = code;
+    int *sp = _stack.data();
+
+    while (true) {
+        const Instruction &ins = *pc++;
+        switch (ins.op) {
+            case OP_PUSH_CONST:
+                *sp++ = ins.operand;
+                break;
+            case OP_LOAD:
+                if (!state.isDefined(ins.operand)) error("VARIABLE NOT DEFINED");
+                *sp++ = state.getValue(ins.operand);
+                break;
+            case OP_STORE:
+                state.setValue(ins.operand, *--sp);
+                break;
+            case OP_ASSIGN:
+                state.setValue(ins.operand, sp[-1]);
+                break;
+            case OP_ADD:
+                --sp;
+                sp[-1] = sp[-1] + sp[0];
+                break;
+            case OP_SUB:
+                --sp;
+                sp[-1] = sp[-1] - sp[0];
+                break;
+            case OP_MUL:
+                --sp;
+                sp[-1] = sp[-1] * sp[0];
+                break;
+            case OP_DIV:
+                --sp;
+                if (sp[0] == 0) error("DIVIDE BY ZERO");
+                sp[-1] = sp[-1] / sp[0];
+                break;
+            case OP_JUMP:
+                pc = code + ins.operand;
+                break;
+            case OP_JUMP_LESS:
+                sp -= 2;
+                if (sp[0] < sp[1]) pc = code + ins.operand;
+                break;
+            case OP_JUMP_GREATER:
+                sp -= 2;
+                if (sp[0] > sp[1]) pc = code + ins.operand;
+                break;
+            case OP_JUMP_EQUAL:
+                sp -= 2;
+                if (sp[0] == sp[1]) pc = code + ins.operand;
+                break;
+            case OP_PRINT:
+                output().writeNumber(*--sp);
+                output().endLine();
+                break;
+            case OP_INPUT:
+                state.setValue(ins.operand, readInputValue());
+                break;
+            case OP_FAIL:
+                error(bytecode.messages[ins.operand]);
+                break;
+            case OP_HALT:
+                return;
+            case OP_ADD_CONST:
+                sp[-1] = sp[-1] + ins.operand;
+                break;
+            case OP_SUB_CONST:
+                sp[-1] = sp[-1] - ins.operand;
+                break;
+            case OP_MUL_CONST:
+                sp[-1] = sp[-1] * ins.operand;
+                break;
+            case OP_DIV_CONST:
+                if (ins.operand == 0) error("DIVIDE BY ZERO");
+                sp[-1] = sp[-1] / ins.operand;
+                break;
+            case OP_ADD_LOAD:
+                if (!state.isDefined(ins.operand)) error("VARIABLE NOT DEFINED");
+                sp[-1] = sp[-1] + state.getValue(ins.operand);
+                break;
+            case OP_SUB_LOAD:
+                if (!state.isDefined(ins.operand)) error("VARIABLE NOT DEFINED");
+                sp[-1] = sp[-1] - state.getValue(ins.operand);
+                break;
+            case OP_MUL_LOAD:
+                if (!state.isDefined(ins.operand)) error("VARIABLE NOT DEFINED");
+                sp[-1] = sp[-1] * state.getValue(ins.operand);
+                break;
+            case OP_DIV_LOAD: {
+                if (!state.isDefined(ins.operand)) error("VARIABLE NOT DEFINED");
+                int right = state.getValue(ins.operand);
+                if (right == 0) error("DIVIDE BY ZERO");
+                sp[-1] = sp[-1] / right;
+                break;
+            }
+            case OP_INC_CONST:
+                if (!state.isDefined(ins.operand)) error("VARIABLE NOT DEFINED");
+                state.setValue(ins.operand, state.getValue(ins.operand) + ins.a);
+                break;
+            case OP_INC_VAR:
+                if (!state.isDefined(ins.operand) || !state.isDefined(ins.a)) {
+                    error("VARIABLE NOT DEFINED");
+                }
+                state.setValue(ins.operand, state.getValue(ins.operand) + state.getValue(ins.a));
+                break;
+            case OP_JUMP_VAR_LESS_VAR:
+                if (!state.isDefined(ins.a) || !state.isDefined(ins.b)) error("VARIABLE NOT DEFINED");
+                if (state.getValue(ins.a) < state.getValue(ins.b)) pc = code + ins.operand;
+                break;
+            case OP_JUMP_VAR_GREATER_VAR:
+                if (!state.isDefined(ins.a) || !state.isDefined(ins.b)) error("VARIABLE NOT DEFINED");
+                if (state.getValue(ins.a) > state.getValue(ins.b)) pc = code + ins.operand;
+                break;
+            case OP_JUMP_VAR_EQUAL_VAR:
+                if (!state.isDefined(ins.a) || !state.isDefined(ins.b)) error("VARIABLE NOT DEFINED");
+                if (state.getValue(ins.a) == state.getValue(ins.b)) pc = code + ins.operand;
+                break;
+            case OP_JUMP_VAR_LESS_CONST:
+                if (!state.isDefined(ins.a)) error("VARIABLE NOT DEFINED");
+                if (state.getValue(ins.a) < ins.b) pc = code + ins.operand;
+                break;
+            case OP_JUMP_VAR_GREATER_CONST:
+                if (!state.isDefined(ins.a)) error("VARIABLE NOT DEFINED");
+                if (state.getValue(ins.a) > ins.b) pc = code + ins.operand;
+                break;
+            case OP_JUMP_VAR_EQUAL_CONST:
+                if (!state.isDefined(ins.a)) error("VARIABLE NOT DEFINED");
+                if (state.getValue(ins.a) == ins.b) pc = code + ins.operand;
+                break;
+        }
+    }
+}
@@ -0,0 +1,38 @@
+/**
+ * @file vm.h
+ *
+ * This interface exports the stack-based virtual machine that executes
+ * the Bytecode produced by the BytecodeCompiler.
+ */
+
+#ifndef _vm_h
+#define _vm_h
+
+#include <vector>
+#include "bytecode.h"
+#include "evalstate.h"
+
+/**
+ * @class VirtualMachine
+ *
+ * The virtual machine reads and writes the variables of the program
+ * directly in the slots of the EvalState, so that direct mode sees the same
+ * variables as after a tree-walking run.
+ */
+class VirtualMachine {
+public:
+    /**
+     * Run
+     * @param bytecode The Compiled Program
+     * @param state Evaluation State to Store the Value of Identifiers
+     *
+     * Executes the bytecode from its first instruction until HALT or an
+     * error.  The output is identical to the one of Program::run.
+     */
+    void run(const Bytecode &bytecode, EvalState &state);
+
+private:
+    std::vector<int> _stack;
+};
+
+#endif
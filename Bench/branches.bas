@@ -0,0 +1,16 @@
+10 LET I = 0
+20 LET A = 0
+30 LET B = 0
+40 REM loop
+50 LET I = I + 1
+60 LET R = I - I / 3 * 3
+70 IF R = 0 THEN 110
+80 IF R = 1 THEN 130
+90 LET B = B + 1
+100 GOTO 140
+110 LET A = A + 1
+120 GOTO 140
+130 LET A = A - 1
+140 IF I < 5000000 THEN 40
+150 PRINT A
+160 PRINT B
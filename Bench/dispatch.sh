@@ -0,0 +1,26 @@
+#!/usr/bin/env bash
+# Times the switch dispatch of the line table against the threaded one:
+# the working tree is built in Release mode with BASIC_THREADED_DISPATCH
+# off and on, and each program of this directory is run by both.  Loops
+# are never compiled in either build, so every line goes through the
+# dispatch of the table.
+#
+# Usage: Bench/dispatch.sh [RUNS]    (best of RUNS runs, 11 by default)
+
+set -euo pipefail
+bench=$(cd "$(dirname "$0")" && pwd)
+root=$(cd "$bench/.." && pwd)
+runs=${1:-11}
+source "$bench/timing.sh"
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+build_tree "$root" "$work/switch" -DBASIC_THREADED_DISPATCH=OFF -DBASIC_HOT_LOOP_THRESHOLD=0
+build_tree "$root" "$work/threaded" -DBASIC_THREADED_DISPATCH=ON -DBASIC_HOT_LOOP_THRESHOLD=0
+
+printf '%-10s %8s %8s\n' program switch threaded
+for program in "$bench"/*.bas; do
+    printf '%-10s %8s %8s\n' "$(basename "$program" .bas)" \
+        "$(best_time "$runs" "$work/switch/Minimal-Basic-Interpreter" "$program")" \
+        "$(best_time "$runs" "$work/threaded/Minimal-Basic-Interpreter" "$program")"
+done
@@ -0,0 +1,8 @@
+10 LET I = 0
+20 LET S = 0
+30 LET A = 7
+40 LET S = S + (I * 3 - I / 2) * (I + 1) - (A * I + 5) / (A + 1)
+50 LET I = I + 1
+60 IF I < 10000000 THEN 40
+70 PRINT S
+80 END
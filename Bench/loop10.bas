@@ -0,0 +1,6 @@
+10 LET I = 0
+20 LET S = 0
+30 LET S = S + I * 2 - 1
+40 LET I = I + 1
+50 IF I < 10000000 THEN 30
+60 PRINT S
@@ -0,0 +1,25 @@
+#!/usr/bin/env bash
+# Times the postfix evaluator against the tree walker it replaced: the
+# revision that added Basic/postfix.cpp and its parent are built in
+# Release mode, and each program of this directory is run by both.
+#
+# Usage: Bench/postfix.sh [RUNS]    (best of RUNS runs, 7 by default)
+
+set -euo pipefail
+bench=$(cd "$(dirname "$0")" && pwd)
+root=$(git -C "$bench" rev-parse --show-toplevel)
+runs=${1:-7}
+source "$bench/timing.sh"
+
+postfix=$(git -C "$root" log --diff-filter=A --format=%H -1 -- Basic/postfix.cpp)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+build_revision "$root" "$work/tree" "$postfix^"
+build_revision "$root" "$work/postfix" "$postfix"
+
+printf '%-10s %8s %8s\n' program tree postfix
+for program in "$bench"/*.bas; do
+    printf '%-10s %8s %8s\n' "$(basename "$program" .bas)" \
+        "$(best_time "$runs" "$work/tree/build/Minimal-Basic-Interpreter" "$program")" \
+        "$(best_time "$runs" "$work/postfix/build/Minimal-Basic-Interpreter" "$program")"
+done
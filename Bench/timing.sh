@@ -0,0 +1,40 @@
+# Helpers shared by the benchmark scripts, which source this file.
+
+# build_revision ROOT DIR REVISION [CMAKE ARGUMENTS...]
+# Builds the interpreter as it was at a git revision of the repository at
+# ROOT into DIR, in Release mode.
+build_revision() {
+    local root=$1 dir=$2 revision=$3
+    shift 3
+    mkdir -p "$dir/src"
+    git -C "$root" archive "$revision" | tar -x -C "$dir/src"
+    build_tree "$dir/src" "$dir/build" "$@"
+}
+
+# build_tree SOURCE BUILD [CMAKE ARGUMENTS...]
+# Builds the interpreter from SOURCE into BUILD, in Release mode.  The
+# output of the build is only shown if it fails.
+build_tree() {
+    local source=$1 build=$2
+    shift 2
+    mkdir -p "$build"
+    if ! { cmake -S "$source" -B "$build" -DCMAKE_BUILD_TYPE=Release "$@" &&
+           cmake --build "$build" --target Minimal-Basic-Interpreter -j "$(nproc)"; } >"$build/log" 2>&1; then
+        cat "$build/log" >&2
+        return 1
+    fi
+}
+
+# best_time RUNS COMMAND...
+# Prints the shortest wall time of RUNS runs of the command, in seconds.
+best_time() {
+    local runs=$1 best= start elapsed
+    shift
+    for _ in $(seq "$runs"); do
+        start=$(date +%s%N)
+        "$@" >/dev/null
+        elapsed=$(($(date +%s%N) - start))
+        if [ -z "$best" ] || [ "$elapsed" -lt "$best" ]; then best=$elapsed; fi
+    done
+    awk -v ns="$best" 'BEGIN { printf "%.3f", ns / 1e9 }'
+}
@@ -95,17 +95,7 @@ string TokenScanner::nextToken() {
             isp->unget();
             return scanWord();
         }
-        string op = string(1, ch);
-        while (isOperatorPrefix(op)) {
-            ch = isp->get();
-            if (ch == EOF) break;
-            op += ch;
-        }
-        while (op.length() > 1 && !isOperator(op)) {
-            isp->unget();
-            op.erase(op.length() - 1, 1);
-        }
-        return op;
+        return scanOperator(ch);
     }
 }
 
@@ -137,10 +127,23 @@ void TokenScanner::addWordCharacters(string str) {
 }
 
 void TokenScanner::addOperator(string op) {
-    StringCell *cp = new StringCell;
-    cp->str = op;
-    cp->link = operators;
-    operators = cp;
+    if (op.empty()) return;
+    int node = operatorRoots[(unsigned char) op[0]];
+    if (node == -1) {
+        node = int(operatorNodes.size());
+        operatorNodes.push_back(OperatorNode{op[0], false, -1, -1});
+        operatorRoots[(unsigned char) op[0]] = node;
+    }
+    for (size_t i = 1; i < op.length(); i++) {
+        int next = findOperatorNode(node, (unsigned char) op[i]);
+        if (next == -1) {
+            next = int(operatorNodes.size());
+            operatorNodes.push_back(OperatorNode{op[i], false, -1, operatorNodes[node].child});
+            operatorNodes[node].child = next;
+        }
+        node = next;
+    }
+    operatorNodes[node].terminal = true;
 }
 
 int TokenScanner::getPosition() const {
@@ -265,7 +268,9 @@ void TokenScanner::initScanner() {
     ignoreCommentsFlag = false;
     scanNumbersFlag = false;
     scanStringsFlag = false;
-    operators = NULL;
+    for (int i = 0; i < 256; i++) {
+        operatorRoots[i] = -1;
+    }
 }
 
 /*
@@ -412,24 +417,39 @@ string TokenScanner::scanString() {
 }
 
 /*
- * Implementation notes: isOperator, isOperatorPrefix
- * --------------------------------------------------
- * These methods search the list of operators and return true if the
- * specified operator is either in the list or a prefix of an operator
- * in the list, respectively.  This code could be made considerably more
- * efficient by implementing operators as a trie.
+ * Implementation notes: findOperatorNode, scanOperator
+ * ----------------------------------------------------
+ * The operators are kept in a trie, so that scanning an operator walks
+ * down one node per character instead of comparing the text read so far
+ * with every operator.  scanOperator reads characters for as long as
+ * they extend a path in the trie, remembers the longest path that ends
+ * in a complete operator, and puts the characters read beyond it back
+ * into the stream.  A character that does not start an operator is a
+ * token of its own.
  */
 
-bool TokenScanner::isOperator(string op) {
-    for (StringCell *cp = operators; cp != NULL; cp = cp->link) {
-        if (op == cp->str) return true;
+int TokenScanner::findOperatorNode(int node, int ch) const {
+    for (int cp = operatorNodes[node].child; cp != -1; cp = operatorNodes[cp].sibling) {
+        if ((unsigned char) operatorNodes[cp].ch == ch) return cp;
     }
-    return false;
+    return -1;
 }
 
-bool TokenScanner::isOperatorPrefix(string op) {
-    for (StringCell *cp = operators; cp != NULL; cp = cp->link) {
-        if (startsWith(cp->str, op)) return true;
+string TokenScanner::scanOperator(int ch) {
+    string op = string(1, ch);
+    size_t matched = 1;
+    int node = operatorRoots[(unsigned char) ch];
+    while (node != -1) {
+        if (operatorNodes[node].terminal) matched = op.length();
+        if (operatorNodes[node].child == -1) break;
+        ch = isp->get();
+        if (ch == EOF) break;
+        op += ch;
+        node = findOperatorNode(node, ch);
+    }
+    while (op.length() > matched) {
+        isp->unget();
+        op.erase(op.length() - 1, 1);
     }
-    return false;
+    return op;
 }
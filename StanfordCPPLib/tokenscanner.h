@@ -10,6 +10,7 @@
 
 #include <iostream>
 #include <string>
+#include <vector>
 #include "private/tokenpatch.h"
 
 /*
@@ -304,10 +305,10 @@ private:
  * Private type: StringCell
  * ------------------------
  * This type is used to construct linked lists of cells, which are used
- * to represent both the stack of saved tokens and the set of defined
- * operators.  These types cannot use the Stack and Lexicon classes
- * directly because tokenscanner.h is an extremely low-level interface,
- * and doing so would create circular dependencies in the .h files.
+ * to represent the stack of saved tokens.  This type cannot use the
+ * Stack class directly because tokenscanner.h is an extremely low-level
+ * interface, and doing so would create circular dependencies in the .h
+ * files.
  */
 
     struct StringCell {
@@ -315,6 +316,23 @@ private:
         StringCell *link;
     };
 
+/*
+ * Private type: OperatorNode
+ * --------------------------
+ * This type is a node of the trie that holds the set of defined
+ * operators.  The first character of an operator is looked up in a
+ * table indexed by character; the nodes below it hold one character
+ * each and are chained through their sibling links.  Nodes are stored
+ * in a vector and refer to each other by index, with -1 meaning none.
+ */
+
+    struct OperatorNode {
+        char ch;
+        bool terminal;
+        int child;
+        int sibling;
+    };
+
     enum NumberScannerState {
         INITIAL_STATE,
         BEFORE_DECIMAL_POINT,
@@ -334,7 +352,8 @@ private:
     bool scanStringsFlag;            /* Scanner parses strings       */
     std::string wordChars;           /* Additional word characters   */
     StringCell *savedTokens;         /* Stack of saved tokens        */
-    StringCell *operators;           /* List of multichar operators  */
+    int operatorRoots[256];          /* Trie nodes by first character */
+    std::vector<OperatorNode> operatorNodes; /* Nodes of the trie    */
 
 /* Private method prototypes */
 
@@ -348,9 +367,9 @@ private:
 
     std::string scanString();
 
-    bool isOperator(std::string op);
+    int findOperatorNode(int node, int ch) const;
 
-    bool isOperatorPrefix(std::string op);
+    std::string scanOperator(int ch);
 
 };
 
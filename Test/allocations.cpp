@@ -0,0 +1,100 @@
+/**
+ * @file allocations.cpp
+ *
+ * This test runs a loop of a million iterations in every execution mode
+ * and checks that no memory is left allocated by the run.  Every
+ * operator new and delete of the process is counted.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "../Basic/evalstate.h"
+#include "../Basic/lexer.h"
+#include "../Basic/program.h"
+#include "../Basic/statement.h"
+
+#include "../StanfordCPPLib/error.h"
+
+/** Allocations not yet freed */
+static long liveAllocations = 0;
+
+void *operator new(std::size_t size) {
+    void *memory = std::malloc(size == 0 ? 1 : size);
+    if (memory == nullptr) throw std::bad_alloc();
+    ++liveAllocations;
+    return memory;
+}
+
+void *operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept {
+    if (memory == nullptr) return;
+    --liveAllocations;
+    std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept {
+    operator delete(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept {
+    operator delete(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept {
+    operator delete(memory);
+}
+
+/**
+ * Stores a program line the way the interpreter does, without its number.
+ */
+static void addLine(Program &program, int lineNumber, const std::string &line) {
+    Lexer lexer(line);
+    std::string_view keyword = lexer.nextToken().text;
+    Statement *stmt;
+    if (keyword == "LET") stmt = new LET(line, lexer, true);
+    else if (keyword == "IF") stmt = new IF(line, lexer);
+    else stmt = new END(line, lexer);
+    program.addSourceLine(lineNumber, stmt);
+}
+
+/**
+ * Runs the program once to compile whatever the mode keeps, then again,
+ * and reports how many allocations the second run left behind.
+ */
+template <typename Run>
+static bool check(const char *mode, Program &program, EvalState &state, Run run) {
+    run(program, state);
+    long before = liveAllocations;
+    run(program, state);
+    long leaked = liveAllocations - before;
+    if (leaked == 0 && state.getValue("i") == 1000000) return true;
+    std::cerr << mode << ": " << leaked << " allocations left by the run, i = "
+              << state.getValue("i") << std::endl;
+    return false;
+}
+
+int main() {
+    Program program;
+    EvalState state;
+    addLine(program, 10, "LET i = 0");
+    addLine(program, 20, "LET i = i + 1");
+    addLine(program, 30, "IF i < 1000000 THEN 20");
+    addLine(program, 40, "END");
+
+    bool passed = true;
+    try {
+        passed &= check("RUN", program, state, [](Program &p, EvalState &s) { p.run(s); });
+        passed &= check("RUN VM", program, state, [](Program &p, EvalState &s) { p.runBytecode(s); });
+        passed &= check("RUN REG", program, state, [](Program &p, EvalState &s) { p.runRegisters(s); });
+        passed &= check("RUN JIT", program, state, [](Program &p, EvalState &s) { p.runNative(s); });
+    } catch (ErrorException &ex) {
+        std::cerr << ex.getMessage() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
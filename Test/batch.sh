@@ -0,0 +1,21 @@
+#!/bin/sh
+# Runs the interpreter at $1 in batch mode on programs that cannot be
+# read by their size: one piped through /dev/stdin, and a directory.
+
+interpreter=$1
+status=0
+
+output=$(printf '10 LET x = 6\n20 PRINT x*7\n30 END\n' | "$interpreter" /dev/stdin)
+if [ $? -ne 0 ] || [ "$output" != "42" ]; then
+    echo "piped program: expected 42, got '$output'" >&2
+    status=1
+fi
+
+"$interpreter" / 2>/dev/null
+code=$?
+if [ $code -ne 2 ]; then
+    echo "directory: expected exit status 2, got $code" >&2
+    status=1
+fi
+
+exit $status